@@ -571,8 +571,10 @@ extern "C" JNIEXPORT void JNICALL Java_com_hydra_noods_NooActivity_runFrame(JNIE
 
 extern "C" JNIEXPORT void JNICALL Java_com_hydra_noods_NooActivity_writeSave(JNIEnv *env, jobject obj)
 {
-    core->cartridgeNds.writeSave();
-    core->cartridgeGba.writeSave();
+    // Wait for saves to reach the disk, since the app can be killed at any time after this
+    core->cartridgeNds.flushSave();
+    core->cartridgeGba.flushSave();
+    core->saveStates.flushState();
 }
 
 extern "C" JNIEXPORT void JNICALL Java_com_hydra_noods_NooActivity_restartCore(JNIEnv *env, jobject obj)
@@ -588,7 +590,8 @@ extern "C" JNIEXPORT jint JNICALL Java_com_hydra_noods_NooActivity_checkState(JN
 
 extern "C" JNIEXPORT jboolean JNICALL Java_com_hydra_noods_NooActivity_saveState(JNIEnv *env, jobject obj)
 {
-    return core->saveStates.saveState();
+    // Wait for the state to be written, since the app can be killed at any time after this
+    return core->saveStates.saveState() && core->saveStates.flushState();
 }
 
 extern "C" JNIEXPORT jboolean JNICALL Java_com_hydra_noods_NooActivity_loadState(JNIEnv *env, jobject obj)
@@ -191,10 +191,18 @@ public class NooActivity extends AppCompatActivity
                     @Override
                     public void onClick(DialogInterface dialog, int id)
                     {
-                        // Save the state if confirmed
+                        // Save the state if confirmed, and show an error if it couldn't be written
                         pauseCore();
-                        saveState();
+                        boolean saved = saveState();
                         resumeCore();
+                        if (!saved)
+                        {
+                            AlertDialog.Builder error = new AlertDialog.Builder(NooActivity.this);
+                            error.setTitle("Error");
+                            error.setMessage("The state file couldn't be written.");
+                            error.setNegativeButton("OK", null);
+                            error.create().show();
+                        }
                     }
                 });
 
@@ -0,0 +1,178 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "scheduler.h"
+#include "../core.h"
+#include "../settings.h"
+
+int main(int argc, char **argv)
+{
+    // Show usage if a ROM wasn't given
+    if (argc < 2)
+    {
+        printf("Usage: %s ROM [FRAMES] [TRACE_FILE]\n", argv[0]);
+        printf("       %s --scheduler [EVENTS]\n", argv[0]);
+        return 1;
+    }
+
+    // Compare the scheduler's event queue with its older versions instead of running a ROM
+    if (std::string(argv[1]) == "--scheduler")
+        return benchScheduler((argc > 2) ? atoi(argv[2]) : 10000000);
+
+    // Load an NDS or GBA ROM depending on the extension of the given file
+    std::string path = argv[1];
+    bool gba = (path.find(".gba", path.length() - 4) != std::string::npos);
+    int frames = (argc > 2) ? atoi(argv[2]) : 1000;
+
+    // Run unthrottled and without threads so all work is timed on the main thread
+    Settings::fpsLimiter = 0;
+    Settings::threaded2D = 0;
+    Settings::threaded3D = 0;
+
+    Core *core;
+    try
+    {
+        // Attempt to boot the core
+        core = new Core(gba ? "" : path, gba ? path : "");
+    }
+    catch (CoreError e)
+    {
+        // Report the error if loading wasn't successful
+        switch (e)
+        {
+            case ERROR_BIOS: printf("Error loading BIOS files\n"); break;
+            case ERROR_FIRM: printf("Error loading firmware\n");   break;
+            case ERROR_ROM:  printf("Error loading ROM\n");        break;
+        }
+        return 1;
+    }
+
+    // Record a trace of the run if a file was given for it
+    if (argc > 3)
+    {
+        Tracer::setThreadName("Emulator");
+        Tracer::setEnabled(true);
+    }
+
+    // Allocate a frame buffer large enough for high-resolution 3D
+    uint32_t *framebuffer = new uint32_t[256 * 192 * 8];
+    std::chrono::nanoseconds total(0);
+    CoreStats totals;
+
+    for (int i = 0; i < frames; i++)
+    {
+        // Time a frame of emulation
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        core->runFrame();
+        total += std::chrono::steady_clock::now() - start;
+
+#ifdef PROFILE
+        // Add up the counters published for the frame
+        CoreStats &stats = core->stats;
+        for (int j = 0; j < MAX_TASKS; j++)
+        {
+            totals.taskCounts[j] += stats.taskCounts[j];
+            totals.taskTimes[j] += stats.taskTimes[j];
+        }
+        for (int j = 0; j < MAX_PROFILE_SECTIONS; j++)
+            totals.sectionTimes[j] += stats.sectionTimes[j];
+        for (int j = 0; j < 2; j++)
+        {
+            totals.opcodes[j] += stats.opcodes[j];
+            totals.haltedCycles[j] += stats.haltedCycles[j];
+            totals.idleSkips[j] += stats.idleSkips[j];
+            totals.idleCycles[j] += stats.idleCycles[j];
+        }
+        totals.gxCommands += stats.gxCommands;
+        totals.frameCycles += stats.frameCycles;
+#endif
+
+        // Drain the output like a frontend would
+        // Fewer samples are requested than a frame produces, so a buffer is always ready
+        core->gpu.getFrame(framebuffer, false);
+        delete[] core->spu.getSamples(512);
+    }
+
+    // Report the overall speed
+    double seconds = total.count() / 1000000000.0;
+    printf("Frames:  %d\n", frames);
+    printf("Time:    %.3fs\n", seconds);
+    printf("Speed:   %.1f FPS\n", frames / seconds);
+
+#ifdef PROFILE
+    static const char *sections[] = { "2D", "3D geometry", "3D rendering", "SPU" };
+
+    // Report the time spent in each subsystem, with the interpreter taking what's left
+    uint64_t remaining = total.count();
+    for (int i = 0; i < MAX_PROFILE_SECTIONS; i++)
+        remaining -= totals.sectionTimes[i];
+
+    printf("\n%-16s %10s %10s %7s\n", "Subsystem", "Total", "Per frame", "Share");
+    printf("%-16s %9.1fms %8.3fms %6.1f%%\n", "Interpreter", remaining / 1000000.0,
+        remaining / 1000000.0 / frames, remaining * 100.0 / total.count());
+    for (int i = 0; i < MAX_PROFILE_SECTIONS; i++)
+    {
+        uint64_t time = totals.sectionTimes[i];
+        printf("%-16s %9.1fms %8.3fms %6.1f%%\n", sections[i], time / 1000000.0,
+            time / 1000000.0 / frames, time * 100.0 / total.count());
+    }
+
+    // Report CPU activity and geometry command throughput, with the part of halted time spent skipping idle loops
+    printf("\n%-16s %10s %10s %7s %7s %10s\n", "CPU", "Opcodes", "Per frame", "Halted", "Idle", "Idle skips");
+    for (int i = 0; i < 2; i++)
+    {
+        printf("%-16s %10llu %10llu %6.1f%% %6.1f%% %10llu\n", i ? "ARM7" : "ARM9", (unsigned long long)totals.opcodes[i],
+            (unsigned long long)(totals.opcodes[i] / frames), totals.haltedCycles[i] * 100.0 / totals.frameCycles,
+            totals.idleCycles[i] * 100.0 / totals.frameCycles, (unsigned long long)totals.idleSkips[i]);
+    }
+    printf("%-16s %10llu %10llu\n", "GX commands", (unsigned long long)totals.gxCommands,
+        (unsigned long long)(totals.gxCommands / frames));
+
+    // Report each scheduler task that ran, with the time spent in it
+    printf("\n%-16s %10s %10s %10s\n", "Task", "Events", "Per frame", "Avg time");
+    for (int i = 0; i < MAX_TASKS; i++)
+    {
+        if (!totals.taskCounts[i]) continue;
+        printf("%-16s %10llu %10llu %8.0fns\n", Core::taskNames[i], (unsigned long long)totals.taskCounts[i],
+            (unsigned long long)(totals.taskCounts[i] / frames), double(totals.taskTimes[i]) / totals.taskCounts[i]);
+    }
+#else
+    // Point to the profiling build, which is kept separate so its timing doesn't skew the speed above
+    printf("\nBuild with 'make -f Makefile.bench profile' for a per-subsystem report\n");
+#endif
+
+    // Write the trace once everything has stopped
+    if (argc > 3)
+    {
+        Tracer::setEnabled(false);
+        if (Tracer::dump(argv[3]))
+            printf("\nTrace written to %s\n", argv[3]);
+        else
+            printf("\nError writing trace to %s\n", argv[3]);
+    }
+
+    delete[] framebuffer;
+    delete core;
+    return 0;
+}
@@ -0,0 +1,201 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "scheduler.h"
+#include "../core.h"
+
+// Periods in ARM9 cycles for NDS-like events: scanlines, SPU samples, timers, DMA, GX commands and IRQs
+static const uint32_t periods[] =
+{
+    256 * 6, 355 * 6, 512 * 2, 0x10000 * 2, 0x400 * 2, 0x4000 * 2, 0x40 * 2, 0x2000 * 2,
+    0x800 * 2, 0x100 * 2, 0x8000 * 2, 0x20 * 2, 96, 2, 2, 180, 16, 1000 * 64, 24, 40,
+    128, 300, 768, 64, 512, 2048, 4096, 3, 12, 1536
+};
+
+static_assert(sizeof(periods) / sizeof(periods[0]) == MAX_TASKS, "Too many benchmark periods");
+
+// The scheduler before per-task slots: a vector sorted by cycles, with the front dispatched
+class VectorQueue
+{
+    public:
+        void schedule(uint8_t task, uint64_t cycles)
+        {
+            // Insert after any events due at the same time or earlier
+            Event event = { task, cycles };
+            events.insert(std::upper_bound(events.begin(), events.end(), event), event);
+        }
+
+        uint8_t nextTask()
+        {
+            // Remove the front event and return its task
+            uint8_t task = events[0].task;
+            events.erase(events.begin());
+            return task;
+        }
+
+        uint64_t nextCycles() { return events[0].cycles; }
+
+    private:
+        struct Event
+        {
+            uint8_t task;
+            uint64_t cycles;
+            bool operator<(const Event &event) const { return cycles < event.cycles; }
+        };
+
+        std::vector<Event> events;
+};
+
+// Per-task slots with the next event found by scanning the pending mask after each dispatch
+class SlotQueue
+{
+    public:
+        void schedule(uint8_t task, uint64_t cycles)
+        {
+            // Fill the task's slot, ordering it after events scheduled earlier for the same time
+            eventCycles[task] = cycles;
+            eventOrder[task] = order++;
+            eventMask |= BIT(task);
+            findNextEvent();
+        }
+
+        uint8_t nextTask()
+        {
+            // Clear the next event's slot and search for the one after it
+            uint8_t task = nextEvent;
+            eventMask &= ~BIT(task);
+            findNextEvent();
+            return task;
+        }
+
+        uint64_t nextCycles() { return eventCycles[nextEvent]; }
+
+    private:
+        uint64_t eventCycles[MAX_TASKS] = {};
+        uint32_t eventOrder[MAX_TASKS] = {};
+        uint32_t eventMask = 0;
+        uint32_t order = 0;
+        uint8_t nextEvent = MAX_TASKS;
+
+        void findNextEvent()
+        {
+            // Search the pending slots for the earliest event
+            nextEvent = MAX_TASKS;
+            for (uint32_t mask = eventMask; mask; mask &= mask - 1)
+            {
+                uint8_t task = __builtin_ctz(mask);
+                if (nextEvent == MAX_TASKS || eventCycles[task] < eventCycles[nextEvent] || (eventCycles[task] ==
+                    eventCycles[nextEvent] && int32_t(eventOrder[task] - eventOrder[nextEvent]) < 0))
+                    nextEvent = task;
+            }
+        }
+};
+
+// The current scheduler: per-task slots with a queue of task IDs from last to first to run
+// This mirrors Core::scheduleAt and Core::nextTask
+class TaskQueue
+{
+    public:
+        void schedule(uint8_t task, uint64_t cycles)
+        {
+            // Fill the task's slot; a task that's already pending is moved to the new time
+            if (eventMask & BIT(task))
+            {
+                uint32_t i = eventCount - 1;
+                while (eventQueue[i] != task) i--;
+                memmove(&eventQueue[i], &eventQueue[i + 1], --eventCount - i);
+            }
+            eventCycles[task] = cycles;
+            eventMask |= BIT(task);
+
+            // Insert the task into the queue after any events due at the same time or earlier
+            uint32_t i = 0;
+            while (i < eventCount && eventCycles[eventQueue[i]] > cycles) i++;
+            memmove(&eventQueue[i + 1], &eventQueue[i], eventCount - i);
+            eventQueue[i] = task;
+            eventCount++;
+        }
+
+        uint8_t nextTask()
+        {
+            // Pop the next event off the end of the queue
+            uint8_t task = eventQueue[--eventCount];
+            eventMask &= ~BIT(task);
+            return task;
+        }
+
+        uint64_t nextCycles() { return eventCycles[eventQueue[eventCount - 1]]; }
+
+    private:
+        uint64_t eventCycles[MAX_TASKS] = {};
+        uint8_t eventQueue[MAX_TASKS] = {};
+        uint32_t eventMask = 0;
+        uint32_t eventCount = 0;
+};
+
+template <typename T> static double runQueue(uint32_t pending, uint32_t events, uint64_t &checksum)
+{
+    // Fill the queue with a set of periodic events
+    T queue;
+    for (uint32_t i = 0; i < pending; i++)
+        queue.schedule(i, periods[i]);
+
+    // Time popping the next event and rescheduling it one period later, like a task would
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < events; i++)
+    {
+        uint64_t cycles = queue.nextCycles();
+        uint8_t task = queue.nextTask();
+        queue.schedule(task, cycles + periods[task]);
+        checksum = checksum * 31 + task;
+    }
+    std::chrono::nanoseconds time = std::chrono::steady_clock::now() - start;
+    return double(time.count()) / events;
+}
+
+int benchScheduler(uint32_t events)
+{
+    // Report the time per event for each queue at a range of pending event counts
+    static const uint32_t counts[] = { 4, 8, 16, MAX_TASKS };
+    bool match = true;
+    printf("%-8s %10s %10s %10s\n", "Pending", "Vector", "Slots", "Queue");
+    for (uint32_t pending : counts)
+    {
+        // Run each queue with the same events, checking that they dispatch in the same order
+        uint64_t sums[3] = {};
+        double vector = runQueue<VectorQueue>(pending, events, sums[0]);
+        double slots = runQueue<SlotQueue>(pending, events, sums[1]);
+        double queue = runQueue<TaskQueue>(pending, events, sums[2]);
+        printf("%-8u %8.1fns %8.1fns %8.1fns\n", pending, vector, slots, queue);
+        match &= (sums[0] == sums[1] && sums[0] == sums[2]);
+    }
+
+    if (!match)
+    {
+        printf("Error: the queues dispatched events in different orders\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,27 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BENCH_SCHEDULER_H
+#define BENCH_SCHEDULER_H
+
+#include <cstdint>
+
+int benchScheduler(uint32_t events);
+
+#endif // BENCH_SCHEDULER_H
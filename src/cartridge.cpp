@@ -17,21 +17,43 @@
     along with NooDS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <cstring>
 
 #include "cartridge.h"
 #include "core.h"
+#include "packed_rom.h"
+#include "rom_cache.h"
 #include "settings.h"
 
+#ifdef MMAP_FILES
+#include <sys/mman.h>
+#endif
+
+// Amount of a mapped ROM to page in ahead of cart reads
+#define ROM_READAHEAD 0x40000
+
 Cartridge::~Cartridge()
 {
-    // Update the save file before exiting
-    writeSave();
+    // Update the save file before exiting, and stop the thread that writes it
+    flushSave();
+    if (saveThread)
+    {
+        {
+            std::lock_guard<std::mutex> guard(writeMutex);
+            writeStopping = true;
+            writeCond.notify_all();
+        }
+        saveThread->join();
+        delete saveThread;
+    }
 
-    // Free the ROM and save memory
+    // Free the ROM and save memory, stopping reads from the file first
+    delete romCache;
+    delete packedRom;
     if (romFile) fclose(romFile);
-    if (rom)  delete[] rom;
     if (save) delete[] save;
+    freeRom();
 }
 
 bool Cartridge::setRom(std::string romPath, int romFd, int saveFd, int stateFd, int cheatFd)
@@ -68,6 +90,19 @@ bool Cartridge::loadRom()
     romSize = ftell(romFile);
     fseek(romFile, 0, SEEK_SET);
 
+    // Check if the ROM is packed, in which case its data and size come from the chunks
+    packedRom = new PackedRom(romFile);
+    if (packedRom->open())
+    {
+        LOG("Opened a packed ROM\n");
+        romSize = packedRom->getSize();
+    }
+    else
+    {
+        delete packedRom;
+        packedRom = nullptr;
+    }
+
     // Attempt to load the ROM's save into memory
     if (FILE *saveFile = (saveFd == -1) ? fopen(savePath.c_str(), "rb") : fdopen(dup(saveFd), "rb"))
     {
@@ -88,40 +123,241 @@ bool Cartridge::loadRom()
 
 void Cartridge::loadRomSection(size_t offset, size_t size)
 {
-    // Load a section of the current ROM file into memory
-    if (rom) delete[] rom;
-    rom = new uint8_t[size];
-    fseek(romFile, offset, SEEK_SET);
-    fread(rom, sizeof(uint8_t), size, romFile);
-    core->dldi.patchRom(rom, offset, size);
+    // Reuse the section buffer unless a larger section is needed
+    if (size > sectionSize)
+    {
+        freeRom();
+        rom = new uint8_t[size];
+        sectionSize = size;
+    }
+
+    // Load a section of the current ROM file into memory through the cache
+    if (!romCache) romCache = new RomCache(core, romFile, romSize, packedRom);
+    romCache->read(rom, offset, size);
+}
+
+bool Cartridge::loadRomFile()
+{
+    // Load the whole ROM file into memory and close it
+    freeRom();
+    rom = new uint8_t[romSize];
+    if (packedRom)
+    {
+        // Fail the load if the packed data can't be read, rather than running a partial ROM
+        if (!packedRom->read(rom, 0, romSize))
+        {
+            LOG("Error reading packed ROM data\n");
+            freeRom();
+            return false;
+        }
+    }
+    else
+    {
+        fseek(romFile, 0, SEEK_SET);
+        fread(rom, sizeof(uint8_t), romSize, romFile);
+    }
+    core->dldi.patchRom(rom, 0, romSize);
+    fclose(romFile);
+    romFile = nullptr;
+    return true;
+}
+
+bool Cartridge::mapRom()
+{
+#ifdef MMAP_FILES
+    // Reserve space for the ROM with an extra page, so reads that run a bit past the end are safe like in RAM
+    // Packed ROMs can't be mapped, since their data has to be decompressed
+    size_t page = sysconf(_SC_PAGESIZE);
+    if (romSize <= 0 || packedRom) return false;
+    void *data = mmap(nullptr, romSize + page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) return false;
+
+    // Map the ROM file over the reserved space, so data is only read when it's accessed
+    // Pages are shared with the file cache until they're patched, and patches are never written back
+    if (mmap(data, romSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fileno(romFile), 0) == MAP_FAILED)
+    {
+        munmap(data, romSize + page);
+        return false;
+    }
+
+    // Replace any loaded section with the mapped ROM, which no longer needs the file
+    freeRom();
+    rom = (uint8_t*)data;
+    mapSize = romSize + page;
+    fclose(romFile);
+    romFile = nullptr;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Cartridge::adviseRom(size_t offset, size_t size)
+{
+#ifdef MMAP_FILES
+    // Skip reads that fall within the last hinted range, or if the ROM isn't mapped
+    if (!mapSize || (offset >= adviseStart && offset + size <= adviseEnd) || offset >= (size_t)romSize)
+        return;
+
+    // Hint that data from a cart read onward will be needed soon, since games usually read their files in order
+    size_t page = sysconf(_SC_PAGESIZE);
+    adviseStart = offset & ~(page - 1);
+    adviseEnd = std::min<size_t>(offset + size + ROM_READAHEAD, romSize);
+    madvise(rom + adviseStart, adviseEnd - adviseStart, MADV_WILLNEED);
+#endif
+}
+
+void Cartridge::freeRom()
+{
+    // Release the ROM, depending on whether it was mapped or loaded
+    if (!rom) return;
+#ifdef MMAP_FILES
+    if (mapSize)
+        munmap(rom, mapSize);
+    else
+#endif
+        delete[] rom;
+    rom = nullptr;
+    mapSize = adviseStart = adviseEnd = sectionSize = 0;
+}
+
+void Cartridge::markSave(uint32_t start, uint32_t size)
+{
+    // Mark part of the save as changed, so it's copied on the next update
+    // This should only be called with the save locked
+    dirtyStart = std::min(dirtyStart, start);
+    dirtyEnd = std::max(dirtyEnd, start + size);
+    saveDirty = true;
 }
 
 void Cartridge::writeSave()
 {
-    // Update the save file if the data changed
-    mutex.lock();
-    if (saveDirty)
+    // Wait until the last update is written, so its copy can be reused
+    std::unique_lock<std::mutex> lock(writeMutex);
+    writeCond.wait(lock, [&]{ return !writePending; });
+
+    // Copy the parts of the save that changed, only holding up emulation for as long as that takes
     {
-        if (FILE *saveFile = (saveFd == -1) ? fopen(savePath.c_str(), "wb") : fdopen(dup(saveFd), "wb"))
+        TRACE_SCOPE("Save Copy");
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!saveDirty) return;
+        uint32_t size = std::max(saveSize, 0);
+        copyResized = (saveCopy.size() != size);
+        if (copyResized)
         {
-            // Overwrite and resize without closing the file descriptor
-            if (saveFd != -1)
-            {
-                fseek(saveFile, 0, SEEK_SET);
-                ftruncate(saveFd, saveSize);
-            }
+            saveCopy.assign(save, save + size);
+            copyStart = 0;
+            copyEnd = size;
+        }
+        else
+        {
+            copyStart = std::min(dirtyStart, size);
+            copyEnd = std::min(dirtyEnd, size);
+            memcpy(&saveCopy[copyStart], &save[copyStart], copyEnd - copyStart);
+        }
+        dirtyStart = -1;
+        dirtyEnd = 0;
+        saveDirty = false;
+    }
+
+    // Hand the copy to the writer thread, starting it on first use
+    writePending = true;
+    if (!saveThread) saveThread = new std::thread(&Cartridge::runSaveWriter, this);
+    writeCond.notify_all();
+}
 
-            LOG("Writing save file to disk\n");
-            fwrite(save, sizeof(uint8_t), saveSize, saveFile);
+Cartridge::SaveDirty Cartridge::getSaveDirty()
+{
+    // Get the range of the save that still has to be written
+    std::lock_guard<std::mutex> guard(mutex);
+    return { saveDirty, dirtyStart, dirtyEnd };
+}
+
+void Cartridge::setSaveDirty(SaveDirty value)
+{
+    // Put back a range of the save that still has to be written
+    std::lock_guard<std::mutex> guard(mutex);
+    saveDirty = value.dirty;
+    dirtyStart = value.start;
+    dirtyEnd = value.end;
+}
+
+void Cartridge::flushSave()
+{
+    // Queue any changes to the save and wait until everything is on disk
+    writeSave();
+    std::unique_lock<std::mutex> lock(writeMutex);
+    writeCond.wait(lock, [&]{ return !writePending; });
+}
+
+void Cartridge::runSaveWriter()
+{
+    std::unique_lock<std::mutex> lock(writeMutex);
+
+    while (true)
+    {
+        // Wait for a save update, and stop once everything is written
+        writeCond.wait(lock, [&]{ return writePending || writeStopping; });
+        if (!writePending) return;
+
+        // Write the copy without holding the lock, so the next update can be checked for in the meantime
+        lock.unlock();
+        writeSaveFile();
+        lock.lock();
+        writePending = false;
+        writeCond.notify_all();
+    }
+}
+
+void Cartridge::writeSaveFile()
+{
+    TRACE_SCOPE("Save Write");
+    LOG("Writing save file to disk\n");
+
+    if (saveFd != -1)
+    {
+        // Write only the changed range in place, without closing the file descriptor
+        // The file is only resized and fully rewritten if the save size changed
+        if (FILE *saveFile = fdopen(dup(saveFd), "rb+"))
+        {
+            if (copyResized) ftruncate(saveFd, saveCopy.size());
+            fseek(saveFile, copyStart, SEEK_SET);
+            fwrite(&saveCopy[copyStart], sizeof(uint8_t), copyEnd - copyStart, saveFile);
+            fflush(saveFile);
+            fsync(fileno(saveFile));
             fclose(saveFile);
-            saveDirty = false;
         }
+        return;
+    }
+
+    // Write the whole save to a temporary file and flush it to disk
+    std::string tempPath = savePath + ".tmp";
+    FILE *saveFile = fopen(tempPath.c_str(), "wb");
+    if (!saveFile) return;
+    bool written = (fwrite(saveCopy.data(), sizeof(uint8_t), saveCopy.size(), saveFile) == saveCopy.size());
+    written &= !fflush(saveFile) && !fsync(fileno(saveFile));
+    fclose(saveFile);
+
+    // Replace the save file with the new one, so an interrupted write never leaves it incomplete
+    // Windows can't rename over an existing file, so it has to be removed first there
+    if (written)
+    {
+#ifdef WINDOWS
+        remove(savePath.c_str());
+#endif
+        rename(tempPath.c_str(), savePath.c_str());
+    }
+    else
+    {
+        remove(tempPath.c_str());
     }
-    mutex.unlock();
 }
 
 void Cartridge::trimRom()
 {
+    // Leave packed ROMs alone, since trimming them would replace them with their unpacked data
+    if (packedRom) return;
+
     // Starting from the end, reduce the ROM size until a non-filler word is found
     int newSize;
     for (newSize = romSize & ~3; newSize > 0; newSize -= 4)
@@ -136,7 +372,7 @@ void Cartridge::trimRom()
         romSize = newSize;
         uint8_t *newRom = new uint8_t[newSize];
         memcpy(newRom, rom, newSize * sizeof(uint8_t));
-        delete[] rom;
+        freeRom();
         rom = newRom;
 
         // Update the ROM file
@@ -173,10 +409,23 @@ void Cartridge::resizeSave(int newSize, bool dirty)
     delete[] save;
     save = newSave;
     saveSize = newSize;
-    if (dirty) saveDirty = true;
+    if (dirty) markSave(0, newSize);
+
+    // Grow the state reserve if needed; only a frontend changing the save type should ever have to
+    if (saveReserve < newSize)
+    {
+        if (!dirty) LOG("Save size 0x%X exceeds its state reserve of 0x%X\n", newSize, saveReserve);
+        saveReserve = newSize;
+    }
     mutex.unlock();
 }
 
+uint32_t Cartridge::getStatePadding()
+{
+    // Get the space needed to fill the save to its reserved size in states
+    return saveReserve - std::max(saveSize, 0);
+}
+
 void CartridgeNds::saveState(MemFile &file)
 {
     // Write state data to the file
@@ -202,8 +451,11 @@ void CartridgeNds::saveState(MemFile &file)
 
 void CartridgeNds::loadState(MemFile &file)
 {
-    // Read state data from the file
-    fread(&saveSize, sizeof(saveSize), 1, file);
+    // Read state data from the file, resizing the save first if the state's is a different size
+    int size = saveSize;
+    fread(&size, sizeof(size), 1, file);
+    if (size > 0 && size != saveSize) resizeSave(size, false);
+    saveSize = size;
     if (saveSize > 0) fread(save, 1, saveSize, file);
     fread(&cmdMode, sizeof(cmdMode), 1, file);
     fread(encTable, 4, sizeof(encTable) / 4, file);
@@ -223,7 +475,10 @@ void CartridgeNds::loadState(MemFile &file)
     fread(romCmdOut, 8, sizeof(romCmdOut) / 8, file);
 
     // Don't overwrite the save file right away; wait until it's modified
+    // All of it was replaced though, so it should all be copied when that happens
     saveDirty = false;
+    dirtyStart = 0;
+    dirtyEnd = -1;
 }
 
 bool CartridgeNds::loadRom()
@@ -243,18 +498,26 @@ bool CartridgeNds::loadRom()
         saveSizes.push_back(0x800000); // FLASH 8192KB
     }
 
-    // Try to load the ROM into RAM if enabled; otherwise fall back to file-based loading
+    // Try to map the ROM or load it into RAM if enabled; otherwise fall back to file-based loading
     if (!Cartridge::loadRom())
     {
         return false;
     }
+    else if (Settings::mmapRom && mapRom())
+    {
+        // Patch DLDI drivers in the ARM9 and ARM7 code, where they're found, without reading the whole ROM
+        for (int i = 0x20; i <= 0x30; i += 0x10)
+        {
+            uint32_t offset = U8TO32(rom, i), size = U8TO32(rom, i + 0xC);
+            if (offset < (uint32_t)romSize)
+                core->dldi.patchRom(&rom[offset], offset, std::min<uint32_t>(size, romSize - offset) & ~3);
+        }
+    }
     else if (Settings::romInRam)
     {
         try
         {
-            loadRomSection(0, romSize);
-            fclose(romFile);
-            romFile = nullptr;
+            if (!loadRomFile()) return false;
         }
         catch (std::bad_alloc &ba)
         {
@@ -293,6 +556,10 @@ bool CartridgeNds::loadRom()
             romEncrypted = true;
         }
     }
+
+    // Reserve state space for the save that detection will create, or the largest one it can guess
+    saveReserve = (saveSize != -1) ? saveSize : lookupSaveSize();
+    if (saveSize == -1 && !saveReserve) saveReserve = 0x80000;
     return true;
 }
 
@@ -497,6 +764,32 @@ void CartridgeNds::applyKeycode()
 
 void CartridgeNds::wordReady(bool cpu)
 {
+    // Finish a streamed block at the time its last word would have been transferred
+    if (readCount[cpu] == blockSize[cpu])
+    {
+        endBlock(cpu);
+        return;
+    }
+
+    // Stream a whole block at once if a DMA is set to transfer it a word at a time
+    // This saves two events per word, but the block still takes as long to finish
+    int channel = (readCount[cpu] == 0) ? core->dma[cpu].streamChannel((cpu == 0) ? 5 : 2) : -1;
+    if (channel >= 0)
+    {
+        uint32_t count = blockSize[cpu] / 4;
+        uint32_t words[0x4000 / 4];
+        for (uint32_t i = 0; i < count; i++)
+        {
+            readCount[cpu] += 4;
+            words[i] = readRomWord(cpu);
+        }
+        core->dma[cpu].streamWords(channel, words, count);
+
+        // Each word would be read by a DMA a cycle after it's ready, with the next one ready later
+        core->schedule(SchedTask(CART9_WORD_READY + cpu), (count - 1) * wordCycles[cpu] + count);
+        return;
+    }
+
     // Indicate that a word is ready
     romCtrl[cpu] |= BIT(23);
 
@@ -539,7 +832,11 @@ void CartridgeNds::writeAuxSpiData(bool cpu, uint8_t value)
     else
     {
         // Get save size from database
-        if (saveSize == -1) detectSaveSize();
+        if (saveSize == -1)
+        {
+            if (int size = lookupSaveSize())
+                resizeSave(size, false);
+        }
 
         // Incredibly naive save type detection, based on commands that might be sent
         if (saveSize == -1)
@@ -624,7 +921,7 @@ void CartridgeNds::writeAuxSpiData(bool cpu, uint8_t value)
                             {
                                 mutex.lock();
                                 save[auxAddress[cpu]] = value;
-                                saveDirty = true;
+                                markSave(auxAddress[cpu], 1);
                                 mutex.unlock();
                             }
 
@@ -649,7 +946,7 @@ void CartridgeNds::writeAuxSpiData(bool cpu, uint8_t value)
                             {
                                 mutex.lock();
                                 save[auxAddress[cpu]] = value;
-                                saveDirty = true;
+                                markSave(auxAddress[cpu], 1);
                                 mutex.unlock();
                             }
 
@@ -707,7 +1004,7 @@ void CartridgeNds::writeAuxSpiData(bool cpu, uint8_t value)
                             {
                                 mutex.lock();
                                 save[auxAddress[cpu]] = value;
-                                saveDirty = true;
+                                markSave(auxAddress[cpu], 1);
                                 mutex.unlock();
                             }
 
@@ -763,7 +1060,7 @@ void CartridgeNds::writeAuxSpiData(bool cpu, uint8_t value)
                             {
                                 mutex.lock();
                                 save[auxAddress[cpu]] = value;
-                                saveDirty = true;
+                                markSave(auxAddress[cpu], 1);
                                 mutex.unlock();
                             }
 
@@ -876,6 +1173,7 @@ void CartridgeNds::writeRomCtrl(bool cpu, uint32_t mask, uint32_t value)
             romAddrReal[cpu] = ((command & 0x0FFFF00000000000) >> 44) * 0x1000;
 
             // Load the secure area block from file if needed
+            adviseRom(romAddrReal[cpu], blockSize[cpu]);
             if (romFile)
             {
                 loadRomSection(romAddrReal[cpu], blockSize[cpu]);
@@ -898,6 +1196,7 @@ void CartridgeNds::writeRomCtrl(bool cpu, uint32_t mask, uint32_t value)
             romAddrReal[cpu] = (command >> 24) & romMask;
 
             // Load the ROM data from file if needed
+            adviseRom(romAddrReal[cpu], blockSize[cpu]);
             if (romFile)
             {
                 if (romAddrReal[cpu] < 0x8000)
@@ -950,22 +1249,26 @@ uint32_t CartridgeNds::readRomDataIn(bool cpu)
     // Mark the next word as not ready
     romCtrl[cpu] &= ~BIT(23);
 
-    // Increment the read counter
+    // Increment the read counter, and end the transfer when the block size has been reached
     if ((readCount[cpu] += 4) == blockSize[cpu])
-    {
-        // End the transfer when the block size has been reached
-        romCtrl[cpu] &= ~BIT(31); // Block ready
-
-        // Trigger a block ready IRQ if enabled
-        if (auxSpiCnt[cpu] & BIT(14))
-            core->interpreter[cpu].sendInterrupt(19);
-    }
-    else
-    {
-        // Schedule the next word to be ready
+        endBlock(cpu);
+    else // Schedule the next word to be ready
         core->schedule(SchedTask(CART9_WORD_READY + cpu), wordCycles[cpu]);
-    }
+    return readRomWord(cpu);
+}
 
+void CartridgeNds::endBlock(bool cpu)
+{
+    // End the transfer
+    romCtrl[cpu] &= ~BIT(31); // Block ready
+
+    // Trigger a block ready IRQ if enabled
+    if (auxSpiCnt[cpu] & BIT(14))
+        core->interpreter[cpu].sendInterrupt(19);
+}
+
+uint32_t CartridgeNds::readRomWord(bool cpu)
+{
     // Return a value from the cart depending on the current command
     switch (cmdMode)
     {
@@ -1040,8 +1343,11 @@ void CartridgeGba::saveState(MemFile &file)
 
 void CartridgeGba::loadState(MemFile &file)
 {
-    // Read state data from the file
-    fread(&saveSize, sizeof(saveSize), 1, file);
+    // Read state data from the file, resizing the save first if the state's is a different size
+    int size = saveSize;
+    fread(&size, sizeof(size), 1, file);
+    if (size > 0 && size != saveSize) resizeSave(size, false);
+    saveSize = size;
     if (saveSize > 0) fread(save, 1, saveSize, file);
     fread(&eepromCount, sizeof(eepromCount), 1, file);
     fread(&eepromCmd, sizeof(eepromCmd), 1, file);
@@ -1052,7 +1358,10 @@ void CartridgeGba::loadState(MemFile &file)
     fread(&flashErase, sizeof(flashErase), 1, file);
 
     // Don't overwrite the save file right away; wait until it's modified
+    // All of it was replaced though, so it should all be copied when that happens
     saveDirty = false;
+    dirtyStart = 0;
+    dirtyEnd = -1;
 }
 
 bool CartridgeGba::findString(std::string string)
@@ -1091,11 +1400,16 @@ bool CartridgeGba::loadRom()
         saveSizes.push_back(0x20000); // FLASH 128KB
     }
 
-    // Load the ROM into memory
+    // Map the ROM if enabled, or load it into memory
     if (!Cartridge::loadRom()) return false;
-    loadRomSection(0, romSize);
-    fclose(romFile);
-    romFile = nullptr;
+    if (Settings::mmapRom && mapRom())
+    {
+        core->dldi.patchRom(rom, 0, romSize);
+    }
+    else if (!loadRomFile())
+    {
+        return false;
+    }
 
     // Calculate the mask for ROM mirroring
     if (romSize > 0xAC && rom[0xAC] == 'F') // NES classic
@@ -1118,6 +1432,10 @@ bool CartridgeGba::loadRom()
     core->memory.updateMap9(0x08000000, 0x0A000000);
     core->memory.updateMap7(0x08000000, 0x0D000000);
 
+    // Reserve state space for the largest EEPROM, since only that is left undetected by the string search
+    // Other types are detected below, and resizing to them grows the reserve before any state is made
+    saveReserve = (saveSize != -1) ? saveSize : 0x2000;
+
     // If the save size is unknown, try to detect it
     if (saveSize == -1)
     {
@@ -1246,7 +1564,7 @@ void CartridgeGba::eepromWrite(uint8_t value)
             uint16_t addr = (saveSize == 0x200) ? ((eepromCmd & 0x3F00) >> 8) : (eepromCmd & 0x03FF);
             for (unsigned int i = 0; i < 8; i++)
                 save[addr * 8 + i] = eepromData >> (i * 8);
-            saveDirty = true;
+            markSave(addr * 8, 8);
             mutex.unlock();
 
             // Reset the transfer
@@ -1296,7 +1614,7 @@ void CartridgeGba::sramWrite(uint32_t address, uint8_t value)
         // Write a single byte because the data bus is only 8 bits
         mutex.lock();
         save[address - 0xE000000] = value;
-        saveDirty = true;
+        markSave(address - 0xE000000, 1);
         mutex.unlock();
     }
     else if ((saveSize == 0x10000 || saveSize == 0x20000) && address < 0xE010000) // FLASH
@@ -1308,7 +1626,7 @@ void CartridgeGba::sramWrite(uint32_t address, uint8_t value)
             if (bankSwap) address += 0x10000;
             mutex.lock();
             save[address - 0xE000000] = value;
-            saveDirty = true;
+            markSave(address - 0xE000000, 1);
             mutex.unlock();
             flashCmd = 0xF0;
         }
@@ -1318,7 +1636,7 @@ void CartridgeGba::sramWrite(uint32_t address, uint8_t value)
             if (bankSwap) address += 0x10000;
             mutex.lock();
             memset(&save[address - 0xE000000], 0xFF, 0x1000 * sizeof(uint8_t));
-            saveDirty = true;
+            markSave(address - 0xE000000, 0x1000);
             mutex.unlock();
             flashErase = false;
         }
@@ -1346,7 +1664,7 @@ void CartridgeGba::sramWrite(uint32_t address, uint8_t value)
             {
                 mutex.lock();
                 memset(save, 0xFF, saveSize * sizeof(uint8_t));
-                saveDirty = true;
+                markSave(0, saveSize);
                 mutex.unlock();
             }
         }
@@ -20,15 +20,19 @@
 #ifndef CARTRIDGE_H
 #define CARTRIDGE_H
 
+#include <condition_variable>
 #include <cstdint>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "defines.h"
 #include "memfile.h"
 
 class Core;
+class PackedRom;
+class RomCache;
 
 enum NdsCmdMode
 {
@@ -47,9 +51,16 @@ class Cartridge
 
         bool setRom(std::string romPath, int romFd = -1, int saveFd = -1, int stateFd = -1, int cheatFd = -1);
         void writeSave();
+        void flushSave();
+
+        // The parts of the save that haven't been written yet, for keeping them across temporary state loads
+        struct SaveDirty { bool dirty; uint32_t start, end; };
+        SaveDirty getSaveDirty();
+        void setSaveDirty(SaveDirty value);
 
         void trimRom();
         void resizeSave(int newSize, bool dirty = true);
+        uint32_t getStatePadding();
 
         int getRomSize()  { return romSize;  }
         int getSaveSize() { return saveSize; }
@@ -59,19 +70,41 @@ class Cartridge
 
         FILE *romFile = nullptr;
         uint8_t *rom = nullptr, *save = nullptr;
-        int romSize = 0, saveSize = -1;
+        int romSize = 0, saveSize = -1, saveReserve = 0;
+        size_t mapSize = 0, adviseStart = 0, adviseEnd = 0;
+        size_t sectionSize = 0;
+        RomCache *romCache = nullptr;
+        PackedRom *packedRom = nullptr;
         bool saveDirty = false;
+        uint32_t dirtyStart = -1, dirtyEnd = 0;
         std::mutex mutex;
 
         std::vector<uint32_t> saveSizes;
         uint32_t romMask = 0;
 
         virtual bool loadRom();
+        void markSave(uint32_t start, uint32_t size);
         void loadRomSection(size_t offset, size_t size);
+        bool loadRomFile();
+        bool mapRom();
+        void adviseRom(size_t offset, size_t size);
+        void freeRom();
 
     private:
         std::string romPath, savePath;
         int romFd = -1, saveFd = -1;
+
+        // Copy of the save that's written to disk on a separate thread
+        std::vector<uint8_t> saveCopy;
+        uint32_t copyStart = 0, copyEnd = 0;
+        bool copyResized = false;
+        std::thread *saveThread = nullptr;
+        std::condition_variable writeCond;
+        std::mutex writeMutex;
+        bool writePending = false, writeStopping = false;
+
+        void runSaveWriter();
+        void writeSaveFile();
 };
 
 class CartridgeNds: public Cartridge
@@ -118,16 +151,18 @@ class CartridgeNds: public Cartridge
         uint64_t romCmdOut[2] = {};
 
         virtual bool loadRom();
+        void endBlock(bool cpu);
+        uint32_t readRomWord(bool cpu);
 
         uint64_t encrypt64(uint64_t value);
         uint64_t decrypt64(uint64_t value);
         void initKeycode(int level);
         void applyKeycode();
-        void detectSaveSize();
+        int lookupSaveSize();
 };
 
 #ifndef __LIBRETRO__
-FORCE_INLINE void CartridgeNds::detectSaveSize() {}
+FORCE_INLINE int CartridgeNds::lookupSaveSize() { return 0; }
 #endif
 
 class CartridgeGba: public Cartridge
@@ -24,13 +24,24 @@
 #include "core.h"
 #include "settings.h"
 
+const char *Core::taskNames[] =
+{
+    "CART9_WORD_READY", "CART7_WORD_READY", "DMA9_TRANSFER0", "DMA9_TRANSFER1", "DMA9_TRANSFER2",
+    "DMA9_TRANSFER3", "DMA7_TRANSFER0", "DMA7_TRANSFER1", "DMA7_TRANSFER2", "DMA7_TRANSFER3",
+    "NDS_SCANLINE256", "NDS_SCANLINE355", "GBA_SCANLINE240", "GBA_SCANLINE308", "GPU3D_COMMAND",
+    "ARM9_INTERRUPT", "ARM7_INTERRUPT", "NDS_SPU_SAMPLE", "GBA_SPU_SAMPLE", "TIMER9_OVERFLOW0",
+    "TIMER9_OVERFLOW1", "TIMER9_OVERFLOW2", "TIMER9_OVERFLOW3", "TIMER7_OVERFLOW0", "TIMER7_OVERFLOW1",
+    "TIMER7_OVERFLOW2", "TIMER7_OVERFLOW3", "WIFI_COUNT_MS", "WIFI_TRANS_REPLY", "WIFI_TRANS_ACK"
+};
+
 Core::Core(std::string ndsRom, std::string gbaRom, int id, int ndsRomFd, int gbaRomFd,
     int ndsSaveFd, int gbaSaveFd, int ndsStateFd, int gbaStateFd, int ndsCheatFd):
     id(id), actionReplay(this), bios { Bios(this, 0, Bios::swiTable9), Bios(this, 1, Bios::swiTable7), Bios(this, 1,
     Bios::swiTableGba) }, cartridgeGba(this), cartridgeNds(this), cp15(this), divSqrt(this), dldi(this), dma {
     Dma(this, 0), Dma(this, 1) }, gpu(this), gpu2D { Gpu2D(this, 0), Gpu2D(this, 1) }, gpu3D(this), gpu3DRenderer(this),
-    input(this), interpreter { Interpreter(this, 0), Interpreter(this, 1) }, ipc(this), memory(this),
-    rtc(this), saveStates(this), spi(this), spu(this), timers { Timers(this, 0), Timers(this, 1) }, wifi(this)
+    input(this), interpreter { Interpreter(this, 0), Interpreter(this, 1) }, ipc(this), jit(this), memory(this),
+    rewind(this), rtc(this), saveStates(this), spi(this), spu(this), timers { Timers(this, 0), Timers(this, 1) },
+    wifi(this)
 {
     // Try to load BIOS and firmware; require DS files when not direct booting
     bool required = !Settings::directBoot || (ndsRom == "" && gbaRom == "" && ndsRomFd == -1 && gbaRomFd == -1);
@@ -39,41 +50,7 @@ Core::Core(std::string ndsRom, std::string gbaRom, int id, int ndsRomFd, int gba
     if (!spi.loadFirmware() && required) throw ERROR_FIRM;
     realGbaBios = memory.loadGbaBios();
 
-    // Define the tasks that can be scheduled
-    tasks[RESET_CYCLES] = std::bind(&Core::resetCycles, this);
-    tasks[CART9_WORD_READY] = std::bind(&CartridgeNds::wordReady, &cartridgeNds, 0);
-    tasks[CART7_WORD_READY] = std::bind(&CartridgeNds::wordReady, &cartridgeNds, 1);
-    tasks[DMA9_TRANSFER0] = std::bind(&Dma::transfer, &dma[0], 0);
-    tasks[DMA9_TRANSFER1] = std::bind(&Dma::transfer, &dma[0], 1);
-    tasks[DMA9_TRANSFER2] = std::bind(&Dma::transfer, &dma[0], 2);
-    tasks[DMA9_TRANSFER3] = std::bind(&Dma::transfer, &dma[0], 3);
-    tasks[DMA7_TRANSFER0] = std::bind(&Dma::transfer, &dma[1], 0);
-    tasks[DMA7_TRANSFER1] = std::bind(&Dma::transfer, &dma[1], 1);
-    tasks[DMA7_TRANSFER2] = std::bind(&Dma::transfer, &dma[1], 2);
-    tasks[DMA7_TRANSFER3] = std::bind(&Dma::transfer, &dma[1], 3);
-    tasks[NDS_SCANLINE256] = std::bind(&Gpu::scanline256, &gpu);
-    tasks[NDS_SCANLINE355] = std::bind(&Gpu::scanline355, &gpu);
-    tasks[GBA_SCANLINE240] = std::bind(&Gpu::gbaScanline240, &gpu);
-    tasks[GBA_SCANLINE308] = std::bind(&Gpu::gbaScanline308, &gpu);
-    tasks[GPU3D_COMMAND] = std::bind(&Gpu3D::runCommand, &gpu3D);
-    tasks[ARM9_INTERRUPT] = std::bind(&Interpreter::interrupt, &interpreter[0]);
-    tasks[ARM7_INTERRUPT] = std::bind(&Interpreter::interrupt, &interpreter[1]);
-    tasks[NDS_SPU_SAMPLE] = std::bind(&Spu::runSample, &spu);
-    tasks[GBA_SPU_SAMPLE] = std::bind(&Spu::runGbaSample, &spu);
-    tasks[TIMER9_OVERFLOW0] = std::bind(&Timers::overflow, &timers[0], 0);
-    tasks[TIMER9_OVERFLOW1] = std::bind(&Timers::overflow, &timers[0], 1);
-    tasks[TIMER9_OVERFLOW2] = std::bind(&Timers::overflow, &timers[0], 2);
-    tasks[TIMER9_OVERFLOW3] = std::bind(&Timers::overflow, &timers[0], 3);
-    tasks[TIMER7_OVERFLOW0] = std::bind(&Timers::overflow, &timers[1], 0);
-    tasks[TIMER7_OVERFLOW1] = std::bind(&Timers::overflow, &timers[1], 1);
-    tasks[TIMER7_OVERFLOW2] = std::bind(&Timers::overflow, &timers[1], 2);
-    tasks[TIMER7_OVERFLOW3] = std::bind(&Timers::overflow, &timers[1], 3);
-    tasks[WIFI_COUNT_MS] = std::bind(&Wifi::countMs, &wifi);
-    tasks[WIFI_TRANS_REPLY] = std::bind(&Wifi::transmitPacket, &wifi, CMD_REPLY);
-    tasks[WIFI_TRANS_ACK] = std::bind(&Wifi::transmitPacket, &wifi, CMD_ACK);
-
     // Schedule initial tasks for NDS mode
-    schedule(RESET_CYCLES, 0x7FFFFFFF);
     schedule(NDS_SCANLINE256, 256 * 6);
     schedule(NDS_SCANLINE355, 355 * 6);
     schedule(NDS_SPU_SAMPLE, 512 * 2);
@@ -153,52 +130,118 @@ void Core::saveState(MemFile &file)
     fwrite(&gbaMode, sizeof(gbaMode), 1, file);
     fwrite(&globalCycles, sizeof(globalCycles), 1, file);
 
-    // Parse the scheduler and save its events
-    uint32_t count = events.size();
-    fwrite(&count, sizeof(count), 1, file);
-    for (uint32_t i = 0; i < count; i++)
-        fwrite(&events[i], sizeof(events[i]), 1, file);
+    // Save the scheduler's events in the order they would run
+    fwrite(&eventCount, sizeof(eventCount), 1, file);
+    for (int i = eventCount - 1; i >= 0; i--)
+    {
+        SchedTask task = SchedTask(eventQueue[i]);
+        fwrite(&task, sizeof(task), 1, file);
+        fwrite(&eventCycles[task], sizeof(eventCycles[task]), 1, file);
+    }
 }
 
-void Core::loadState(MemFile &file)
+void Core::loadState(MemFile &file, bool oldCycles)
 {
     // Read state data from the file
     fread(&dsiMode, sizeof(dsiMode), 1, file);
     fread(&gbaMode, sizeof(gbaMode), 1, file);
-    fread(&globalCycles, sizeof(globalCycles), 1, file);
+    if (oldCycles)
+    {
+        // Widen the global cycles from old states that stored them as 32-bit
+        uint32_t cycles32 = 0;
+        fread(&cycles32, sizeof(cycles32), 1, file);
+        globalCycles = cycles32;
+    }
+    else
+    {
+        fread(&globalCycles, sizeof(globalCycles), 1, file);
+    }
 
     // Reset the scheduler and refill it with loaded events
-    events.clear();
+    eventMask = 0;
+    eventCount = 0;
     uint32_t count;
-    SchedEvent event(MAX_TASKS, 0);
     fread(&count, sizeof(count), 1, file);
     for (uint32_t i = 0; i < count; i++)
     {
-        fread(&event, sizeof(event), 1, file);
-        events.push_back(event);
+        SchedTask task;
+        uint64_t cycles = 0;
+        fread(&task, sizeof(task), 1, file);
+
+        // Old states had 32-bit event cycles and a cycle reset task before the others
+        // Widen the cycles, drop the reset task, and shift the other IDs down
+        if (oldCycles)
+        {
+            uint32_t cycles32 = 0;
+            fread(&cycles32, sizeof(cycles32), 1, file);
+            cycles = cycles32;
+            if (task == 0) continue;
+            task = SchedTask(task - 1);
+        }
+        else
+        {
+            fread(&cycles, sizeof(cycles), 1, file);
+        }
+        scheduleAt(task, cycles);
     }
 
     // Update the run function pointer
     runFunc = gbaMode ? &Interpreter::runGbaFrame : (dsiMode ? &Interpreter::runDsiFrame : &Interpreter::runNdsFrame);
 }
 
-void Core::resetCycles()
+uint32_t Core::getStatePadding()
 {
-    // Reset the global cycle count periodically to prevent overflow
-    for (size_t i = 0; i < events.size(); i++)
-        events[i].cycles -= globalCycles;
-    for (int i = 0; i < 2; i++)
-        interpreter[i].resetCycles(), timers[i].resetCycles();
-    globalCycles -= globalCycles;
-    schedule(RESET_CYCLES, 0x7FFFFFFF);
+    // Get the space needed to fill the scheduler to one event per task in states
+    return (MAX_TASKS - eventCount) * (sizeof(SchedTask) + sizeof(uint64_t));
 }
 
 void Core::schedule(SchedTask task, uint32_t cycles)
 {
-    // Add a task to the scheduler, sorted by least to most cycles until execution
-    SchedEvent event(task, globalCycles + cycles);
-    auto it = std::upper_bound(events.cbegin(), events.cend(), event);
-    events.insert(it, event);
+    // Add a task to the scheduler, relative to the current cycle count
+    scheduleAt(task, globalCycles + cycles);
+}
+
+void Core::scheduleAt(SchedTask task, uint64_t cycles)
+{
+    // Fill the task's slot; a task that's already pending is moved to the new time
+    if (eventMask & BIT(task))
+        removeEvent(task);
+    eventCycles[task] = cycles;
+    eventMask |= BIT(task);
+
+    // Insert the task into the queue after any events due at the same time or earlier
+    uint32_t i = 0;
+    while (i < eventCount && eventCycles[eventQueue[i]] > cycles) i++;
+    memmove(&eventQueue[i + 1], &eventQueue[i], eventCount - i);
+    eventQueue[i] = task;
+    eventCount++;
+    nextCycles = eventCycles[eventQueue[eventCount - 1]];
+}
+
+void Core::removeEvent(SchedTask task)
+{
+    // Remove a pending task from the queue, searching from the next event since that's most likely
+    uint32_t i = eventCount - 1;
+    while (eventQueue[i] != task) i--;
+    memmove(&eventQueue[i], &eventQueue[i + 1], --eventCount - i);
+    eventMask &= ~BIT(task);
+    nextCycles = eventCount ? eventCycles[eventQueue[eventCount - 1]] : -1;
+}
+
+void Core::unschedule(SchedTask task)
+{
+    // Remove a task from the scheduler if it's pending
+    if (eventMask & BIT(task))
+        removeEvent(task);
+}
+
+SchedTask Core::nextTask()
+{
+    // Pop the next event off the end of the queue and return its task
+    SchedTask task = SchedTask(eventQueue[--eventCount]);
+    eventMask &= ~BIT(task);
+    nextCycles = eventCount ? eventCycles[eventQueue[eventCount - 1]] : -1;
+    return task;
 }
 
 void Core::enterGbaMode()
@@ -209,8 +252,8 @@ void Core::enterGbaMode()
     running.store(false);
 
     // Reset the scheduler and schedule initial tasks for GBA mode
-    events.clear();
-    schedule(RESET_CYCLES, 1);
+    eventMask = 0;
+    eventCount = 0;
     schedule(GBA_SCANLINE240, 240 * 4);
     schedule(GBA_SCANLINE308, 308 * 4);
     schedule(GBA_SPU_SAMPLE, 512);
@@ -253,6 +296,16 @@ void Core::endFrame()
         lastFpsTime = std::chrono::steady_clock::now();
     }
 
+#ifdef PROFILE
+    // Publish the profiling counters for the frame and start counting the next one
+    counters.frameCycles = globalCycles - frameStartCycles;
+    for (int i = 0; i < 2; i++)
+        counters.haltedCycles[i] = counters.frameCycles - std::min(counters.frameCycles, counters.activeCycles[i]);
+    stats = counters;
+    counters = CoreStats();
+    frameStartCycles = globalCycles;
+#endif
+
     // Schedule WiFi updates only when needed
     if (wifi.shouldSchedule())
         wifi.scheduleInit();
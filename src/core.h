@@ -22,9 +22,7 @@
 
 #include <chrono>
 #include <cstdint>
-#include <functional>
 #include <string>
-#include <vector>
 
 #include "memfile.h"
 #include "action_replay.h"
@@ -42,12 +40,16 @@
 #include "input.h"
 #include "interpreter.h"
 #include "ipc.h"
+#include "jit.h"
 #include "memory.h"
+#include "profiler.h"
+#include "rewind.h"
 #include "rtc.h"
 #include "save_states.h"
 #include "spi.h"
 #include "spu.h"
 #include "timers.h"
+#include "tracer.h"
 #include "wifi.h"
 
 enum CoreError
@@ -59,7 +61,6 @@ enum CoreError
 
 enum SchedTask
 {
-    RESET_CYCLES,
     CART9_WORD_READY,
     CART7_WORD_READY,
     DMA9_TRANSFER0,
@@ -93,20 +94,32 @@ enum SchedTask
     MAX_TASKS
 };
 
-struct SchedEvent
-{
-    SchedTask task;
-    uint32_t cycles;
+// Pending tasks are tracked as bits in a 32-bit mask
+static_assert(MAX_TASKS <= 32, "Too many scheduler tasks");
 
-    SchedEvent(SchedTask task, uint32_t cycles): task(task), cycles(cycles) {}
-    bool operator<(const SchedEvent &event) const { return cycles < event.cycles; }
+struct CoreStats
+{
+    uint64_t taskCounts[MAX_TASKS] = {};
+    uint64_t taskTimes[MAX_TASKS] = {};
+    uint64_t sectionTimes[MAX_PROFILE_SECTIONS] = {};
+    uint64_t opcodes[2] = {};
+    uint64_t activeCycles[2] = {};
+    uint64_t haltedCycles[2] = {};
+    uint64_t idleSkips[2] = {};
+    uint64_t idleCycles[2] = {};
+    uint64_t gxCommands = 0;
+    uint64_t frameCycles = 0;
 };
 
 class Core
 {
     public:
         int id = 0;
+        static const char *taskNames[MAX_TASKS];
+
         int fps = 0;
+        CoreStats stats;
+        CoreStats counters;
         bool dsiMode = false;
         bool gbaMode = false;
 
@@ -125,7 +138,9 @@ class Core
         Input input;
         Interpreter interpreter[2];
         Ipc ipc;
+        Jit jit;
         Memory memory;
+        Rewind rewind;
         Rtc rtc;
         SaveStates saveStates;
         Spi spi;
@@ -134,17 +149,20 @@ class Core
         Wifi wifi;
 
         std::atomic<bool> running;
-        std::vector<SchedEvent> events;
-        std::function<void()> tasks[MAX_TASKS];
-        uint32_t globalCycles = 0;
+        uint64_t globalCycles = 0;
+        uint64_t nextCycles = 0;
 
         Core(std::string ndsRom = "", std::string gbaRom = "", int id = 0, int ndsRomFd = -1, int gbaRomFd = -1,
              int ndsSaveFd = -1, int gbaSaveFd = -1, int ndsStateFd = -1, int gbaStateFd = -1, int ndsCheatFd = -1);
         void saveState(MemFile &file);
-        void loadState(MemFile &file);
+        void loadState(MemFile &file, bool oldCycles = false);
+        uint32_t getStatePadding();
 
-        void runFrame() { (*runFunc)(*this); }
+        void runFrame() { TRACE_SCOPE("Frame"); (*runFunc)(*this); }
         void schedule(SchedTask task, uint32_t cycles);
+        void unschedule(SchedTask task);
+        SchedTask nextTask();
+        void runTask(SchedTask task);
         void enterGbaMode();
         void endFrame();
 
@@ -153,8 +171,64 @@ class Core
         void (*runFunc)(Core&) = &Interpreter::runNdsFrame;
         std::chrono::steady_clock::time_point lastFpsTime;
         int fpsCount = 0;
+        uint64_t frameStartCycles = 0;
 
-        void resetCycles();
+        // The scheduler holds one cycle slot per task, with a bit set for each pending slot
+        // Pending tasks are queued from last to first to run, so the next one can be popped off the end
+        uint64_t eventCycles[MAX_TASKS] = {};
+        uint8_t eventQueue[MAX_TASKS] = {};
+        uint32_t eventMask = 0;
+        uint32_t eventCount = 0;
+
+        void scheduleAt(SchedTask task, uint64_t cycles);
+        void removeEvent(SchedTask task);
 };
 
+FORCE_INLINE void Core::runTask(SchedTask task)
+{
+    TRACE_SCOPE(taskNames[task]);
+
+#ifdef PROFILE
+    // Count the task and time how long it runs
+    counters.taskCounts[task]++;
+    ProfileScope scope(counters.taskTimes[task]);
+#endif
+
+    // Run a scheduled task, calling its member function directly so the run loops can inline the dispatch
+    switch (task)
+    {
+        case CART9_WORD_READY: return cartridgeNds.wordReady(0);
+        case CART7_WORD_READY: return cartridgeNds.wordReady(1);
+        case DMA9_TRANSFER0:   return dma[0].transfer(0);
+        case DMA9_TRANSFER1:   return dma[0].transfer(1);
+        case DMA9_TRANSFER2:   return dma[0].transfer(2);
+        case DMA9_TRANSFER3:   return dma[0].transfer(3);
+        case DMA7_TRANSFER0:   return dma[1].transfer(0);
+        case DMA7_TRANSFER1:   return dma[1].transfer(1);
+        case DMA7_TRANSFER2:   return dma[1].transfer(2);
+        case DMA7_TRANSFER3:   return dma[1].transfer(3);
+        case NDS_SCANLINE256:  return gpu.scanline256();
+        case NDS_SCANLINE355:  return gpu.scanline355();
+        case GBA_SCANLINE240:  return gpu.gbaScanline240();
+        case GBA_SCANLINE308:  return gpu.gbaScanline308();
+        case GPU3D_COMMAND:    return gpu3D.runCommand();
+        case ARM9_INTERRUPT:   return interpreter[0].interrupt();
+        case ARM7_INTERRUPT:   return interpreter[1].interrupt();
+        case NDS_SPU_SAMPLE:   return spu.runSample();
+        case GBA_SPU_SAMPLE:   return spu.runGbaSample();
+        case TIMER9_OVERFLOW0: return timers[0].overflow(0);
+        case TIMER9_OVERFLOW1: return timers[0].overflow(1);
+        case TIMER9_OVERFLOW2: return timers[0].overflow(2);
+        case TIMER9_OVERFLOW3: return timers[0].overflow(3);
+        case TIMER7_OVERFLOW0: return timers[1].overflow(0);
+        case TIMER7_OVERFLOW1: return timers[1].overflow(1);
+        case TIMER7_OVERFLOW2: return timers[1].overflow(2);
+        case TIMER7_OVERFLOW3: return timers[1].overflow(3);
+        case WIFI_COUNT_MS:    return wifi.countMs();
+        case WIFI_TRANS_REPLY: return wifi.transmitPacket(CMD_REPLY);
+        case WIFI_TRANS_ACK:   return wifi.transmitPacket(CMD_ACK);
+        default:               return;
+    }
+}
+
 #endif // CORE_H
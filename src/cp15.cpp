@@ -36,10 +36,12 @@ void Cp15::loadState(MemFile &file)
     fread(&dtcm, sizeof(dtcm), 1, file);
     fread(&itcm, sizeof(itcm), 1, file);
 
-    // Set registers along with values based on them
-    write(1, 0, 0, ctrl);
-    write(9, 1, 0, dtcm);
-    write(9, 1, 1, itcm);
+    // Set registers along with values based on them, skipping ones that didn't change
+    // Writes remap the TCM areas and drop their cached code, which would otherwise happen on every snapshot load
+    // TCM sizes start at zero before their registers are first written, so they're always set then
+    if (ctrl != ctrlReg) write(1, 0, 0, ctrl);
+    if (dtcm != dtcmReg || !dtcmSize) write(9, 1, 0, dtcm);
+    if (itcm != itcmReg || !itcmSize) write(9, 1, 1, itcm);
 }
 
 uint32_t Cp15::read(uint8_t cn, uint8_t cm, uint8_t cp)
@@ -63,11 +65,12 @@ uint32_t Cp15::read(uint8_t cn, uint8_t cm, uint8_t cp)
 void Cp15::write(uint8_t cn, uint8_t cm, uint8_t cp, uint32_t value)
 {
     // Write a value to a CP15 register
-    uint32_t oldAddr, oldSize;
+    uint32_t oldAddr, oldSize, oldAccess;
     switch ((cn << 16) | (cm << 8) | (cp << 0))
     {
         case 0x010000: // Control
             // Set writable control bits and update their state values
+            oldAccess = (dtcmCanRead << 0) | (dtcmCanWrite << 1) | (itcmCanRead << 2) | (itcmCanWrite << 3);
             ctrlReg = (ctrlReg & ~0xFF085) | (value & 0xFF085);
             exceptionAddr = (ctrlReg & BIT(13)) ? 0xFFFF0000 : 0x00000000;
             dtcmCanRead = (ctrlReg & BIT(16)) && !(ctrlReg & BIT(17));
@@ -75,7 +78,9 @@ void Cp15::write(uint8_t cn, uint8_t cm, uint8_t cp, uint32_t value)
             itcmCanRead = (ctrlReg & BIT(18)) && !(ctrlReg & BIT(19));
             itcmCanWrite = (ctrlReg & BIT(18));
 
-            // Update the memory map at the current TCM locations
+            // Update the memory map at the current TCM locations if their access changed
+            if (oldAccess == ((dtcmCanRead << 0) | (dtcmCanWrite << 1) | (itcmCanRead << 2) | (itcmCanWrite << 3)))
+                return;
             core->memory.updateMap9(dtcmAddr, dtcmAddr + dtcmSize, true);
             core->memory.updateMap9(0x00000000, itcmSize, true);
             return;
@@ -88,7 +93,8 @@ void Cp15::write(uint8_t cn, uint8_t cm, uint8_t cp, uint32_t value)
             dtcmAddr = dtcmReg & 0xFFFFF000;
             dtcmSize = std::max(0x1000, 0x200 << ((dtcmReg >> 1) & 0x1F)); // Min 4KB
 
-            // Update the memory map at the old and new DTCM areas
+            // Update the memory map at the old and new DTCM areas if it moved or changed size
+            if (dtcmAddr == oldAddr && dtcmSize == oldSize) return;
             core->memory.updateMap9(oldAddr, oldAddr + oldSize, true);
             core->memory.updateMap9(dtcmAddr, dtcmAddr + dtcmSize, true);
             return;
@@ -104,7 +110,8 @@ void Cp15::write(uint8_t cn, uint8_t cm, uint8_t cp, uint32_t value)
             oldSize = itcmSize;
             itcmSize = std::max(0x1000, 0x200 << ((itcmReg >> 1) & 0x1F)); // Min 4KB
 
-            // Update the memory map at the old and new ITCM areas
+            // Update the memory map at the old and new ITCM areas if it changed size
+            if (itcmSize == oldSize) return;
             core->memory.updateMap9(0x00000000, std::max(oldSize, itcmSize), true);
             return;
 
@@ -33,10 +33,28 @@
 #ifdef NO_FDOPEN
 #define fdopen(...) (0)
 #define ftruncate(...) (0)
+#define fsync(...) (0)
 #else
 #include <unistd.h>
 #endif
 
+// Windows flushes files to disk with a different function
+#ifdef WINDOWS
+#include <io.h>
+#define fsync(fd) _commit(fd)
+#endif
+
+// Enable fastmem on hosts where the ARM9 JIT can alias memory and catch its own faults
+#if defined(__linux__) && defined(__x86_64__) && !defined(NO_FASTMEM)
+#define FASTMEM
+#endif
+
+// Enable memory-mapped ROMs and SD images on hosts known to have POSIX file mapping
+#if (defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || \
+    defined(__OpenBSD__)) && !defined(NO_FDOPEN) && !defined(NO_MMAP)
+#define MMAP_FILES
+#endif
+
 // Macro to handle differing mkdir arguments on Windows
 #ifdef WINDOWS
 #define MKDIR_ARGS
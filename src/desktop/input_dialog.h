@@ -53,6 +53,7 @@ class InputDialog: public wxDialog
         wxButton *keyFullScreen;
         wxButton *keyScreenSwap;
         wxButton *keySystemPause;
+        wxButton *keyRewindHold;
 
         int keyBinds[MAX_KEYS];
         std::vector<int> axisBases;
@@ -79,6 +80,7 @@ class InputDialog: public wxDialog
         void remapFullScreen(wxCommandEvent &event);
         void remapScreenSwap(wxCommandEvent &event);
         void remapSystemPause(wxCommandEvent &event);
+        void remapRewindHold(wxCommandEvent &event);
         void clearMap(wxCommandEvent &event);
         void updateJoystick(wxTimerEvent &event);
         void confirm(wxCommandEvent &event);
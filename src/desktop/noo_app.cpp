@@ -36,7 +36,7 @@ wxEND_EVENT_TABLE()
 
 int NooApp::micEnable = 0;
 int NooApp::splitScreens = 0;
-int NooApp::keyBinds[] = { 'L', 'K', 'G', 'H', 'D', 'A', 'W', 'S', 'P', 'Q', 'O', 'I', WXK_TAB, 0, WXK_ESCAPE, 0, WXK_BACK };
+int NooApp::keyBinds[] = { 'L', 'K', 'G', 'H', 'D', 'A', 'W', 'S', 'P', 'Q', 'O', 'I', WXK_TAB, 0, WXK_ESCAPE, 0, WXK_BACK, 0 };
 
 bool NooApp::OnInit()
 {
@@ -61,7 +61,8 @@ bool NooApp::OnInit()
         Setting("keyFastToggle", &keyBinds[13], false),
         Setting("keyFullScreen", &keyBinds[14], false),
         Setting("keyScreenSwap", &keyBinds[15], false),
-        Setting("keySystemPause", &keyBinds[16], false)
+        Setting("keySystemPause", &keyBinds[16], false),
+        Setting("keyRewindHold", &keyBinds[17], false)
     };
 
     // Add the platform settings
@@ -50,6 +50,7 @@ enum FrameEvent
     FPS_LIMITER,
     MIC_ENABLE,
     ROM_IN_RAM,
+    MMAP_ROM_FILE,
     THREADED_2D,
     THREADED_3D_0,
     THREADED_3D_1,
@@ -57,6 +58,18 @@ enum FrameEvent
     THREADED_3D_3,
     THREADED_3D_4,
     HIGH_RES_3D,
+    ARM9_JIT,
+    IDLE_LOOPS,
+    JIT_FASTMEM,
+    REWIND_0,
+    REWIND_1,
+    REWIND_5,
+    REWIND_10,
+    REWIND_30,
+    REWIND_BUFFER_32,
+    REWIND_BUFFER_64,
+    REWIND_BUFFER_128,
+    REWIND_BUFFER_256,
     UPDATE_JOY
 };
 
@@ -81,6 +94,7 @@ EVT_MENU(DIRECT_BOOT, NooFrame::directBootToggle)
 EVT_MENU(FPS_LIMITER, NooFrame::fpsLimiter)
 EVT_MENU(MIC_ENABLE, NooFrame::micEnable)
 EVT_MENU(ROM_IN_RAM, NooFrame::romInRam)
+EVT_MENU(MMAP_ROM_FILE, NooFrame::mmapRom)
 EVT_MENU(THREADED_2D, NooFrame::threaded2D)
 EVT_MENU(THREADED_3D_0, NooFrame::threaded3D0)
 EVT_MENU(THREADED_3D_1, NooFrame::threaded3D1)
@@ -88,6 +102,18 @@ EVT_MENU(THREADED_3D_2, NooFrame::threaded3D2)
 EVT_MENU(THREADED_3D_3, NooFrame::threaded3D3)
 EVT_MENU(THREADED_3D_4, NooFrame::threaded3D4)
 EVT_MENU(HIGH_RES_3D, NooFrame::highRes3D)
+EVT_MENU(ARM9_JIT, NooFrame::arm9Jit)
+EVT_MENU(IDLE_LOOPS, NooFrame::idleLoops)
+EVT_MENU(JIT_FASTMEM, NooFrame::fastmem)
+EVT_MENU(REWIND_0, NooFrame::rewind0)
+EVT_MENU(REWIND_1, NooFrame::rewind1)
+EVT_MENU(REWIND_5, NooFrame::rewind5)
+EVT_MENU(REWIND_10, NooFrame::rewind10)
+EVT_MENU(REWIND_30, NooFrame::rewind30)
+EVT_MENU(REWIND_BUFFER_32, NooFrame::rewindBuffer32)
+EVT_MENU(REWIND_BUFFER_64, NooFrame::rewindBuffer64)
+EVT_MENU(REWIND_BUFFER_128, NooFrame::rewindBuffer128)
+EVT_MENU(REWIND_BUFFER_256, NooFrame::rewindBuffer256)
 EVT_TIMER(UPDATE_JOY, NooFrame::updateJoystick)
 EVT_DROP_FILES(NooFrame::dropFiles)
 EVT_CLOSE(NooFrame::close)
@@ -157,6 +183,40 @@ NooFrame::NooFrame(NooApp *app, int id, std::string path, NooFrame *partner):
             default: threaded3D->Check(THREADED_3D_4, true); break;
         }
 
+        // Set up the Rewind Interval submenu
+        wxMenu *rewind = new wxMenu();
+        rewind->AppendRadioItem(REWIND_0, "&Disabled");
+        rewind->AppendRadioItem(REWIND_1, "&1 Frame");
+        rewind->AppendRadioItem(REWIND_5, "&5 Frames");
+        rewind->AppendRadioItem(REWIND_10, "1&0 Frames");
+        rewind->AppendRadioItem(REWIND_30, "&30 Frames");
+
+        // Set the current value of the rewind interval setting
+        switch (Settings::rewindFrames)
+        {
+            case 0: rewind->Check(REWIND_0, true); break;
+            case 1: rewind->Check(REWIND_1, true); break;
+            case 5: rewind->Check(REWIND_5, true); break;
+            case 10: rewind->Check(REWIND_10, true); break;
+            default: rewind->Check(REWIND_30, true); break;
+        }
+
+        // Set up the Rewind Buffer submenu
+        wxMenu *rewindBuffer = new wxMenu();
+        rewindBuffer->AppendRadioItem(REWIND_BUFFER_32, "&32 MB");
+        rewindBuffer->AppendRadioItem(REWIND_BUFFER_64, "&64 MB");
+        rewindBuffer->AppendRadioItem(REWIND_BUFFER_128, "&128 MB");
+        rewindBuffer->AppendRadioItem(REWIND_BUFFER_256, "&256 MB");
+
+        // Set the current value of the rewind buffer setting
+        switch (Settings::rewindBudget)
+        {
+            case 32: rewindBuffer->Check(REWIND_BUFFER_32, true); break;
+            case 64: rewindBuffer->Check(REWIND_BUFFER_64, true); break;
+            case 128: rewindBuffer->Check(REWIND_BUFFER_128, true); break;
+            default: rewindBuffer->Check(REWIND_BUFFER_256, true); break;
+        }
+
         // Set up the Settings menu
         wxMenu *settingsMenu = new wxMenu();
         settingsMenu->Append(PATH_SETTINGS, "&Path Settings");
@@ -167,18 +227,29 @@ NooFrame::NooFrame(NooApp *app, int id, std::string path, NooFrame *partner):
         settingsMenu->AppendCheckItem(FPS_LIMITER, "&FPS Limiter");
         settingsMenu->AppendCheckItem(MIC_ENABLE, "&Use Microphone");
         settingsMenu->AppendCheckItem(ROM_IN_RAM, "&Keep ROM in RAM");
+        settingsMenu->AppendCheckItem(MMAP_ROM_FILE, "&Memory-Map ROM");
         settingsMenu->AppendSeparator();
         settingsMenu->AppendCheckItem(THREADED_2D, "&Threaded 2D");
         settingsMenu->AppendSubMenu(threaded3D, "&Threaded 3D");
         settingsMenu->AppendCheckItem(HIGH_RES_3D, "&High-Resolution 3D");
+        settingsMenu->AppendCheckItem(ARM9_JIT, "&ARM9 JIT");
+        settingsMenu->AppendCheckItem(IDLE_LOOPS, "&Skip Idle Loops");
+        settingsMenu->AppendCheckItem(JIT_FASTMEM, "JIT &Fastmem");
+        settingsMenu->AppendSeparator();
+        settingsMenu->AppendSubMenu(rewind, "&Rewind Interval");
+        settingsMenu->AppendSubMenu(rewindBuffer, "Rewind &Buffer");
 
         // Set the initial Settings checkbox states
         settingsMenu->Check(DIRECT_BOOT, Settings::directBoot);
         settingsMenu->Check(FPS_LIMITER, Settings::fpsLimiter);
         settingsMenu->Check(MIC_ENABLE, NooApp::micEnable);
         settingsMenu->Check(ROM_IN_RAM, Settings::romInRam);
+        settingsMenu->Check(MMAP_ROM_FILE, Settings::mmapRom);
         settingsMenu->Check(THREADED_2D, Settings::threaded2D);
         settingsMenu->Check(HIGH_RES_3D, Settings::highRes3D);
+        settingsMenu->Check(ARM9_JIT, Settings::arm9Jit);
+        settingsMenu->Check(IDLE_LOOPS, Settings::idleLoops);
+        settingsMenu->Check(JIT_FASTMEM, Settings::fastmem);
 
         // Set up the menu bar
         wxMenuBar *menuBar = new wxMenuBar();
@@ -239,6 +310,16 @@ void NooFrame::Refresh()
     wxString label = "NooDS";
     if (id > 0) label += wxString::Format(" (%d)", id + 1);
     if (running) label += wxString::Format(" - %d FPS", core->fps);
+    if (core)
+    {
+        // Show the progress of the last state save, and keep an error up if it failed
+        switch (core->saveStates.getWriteStatus())
+        {
+            case WRITE_PENDING: label += " - Saving State"; break;
+            case WRITE_FAILED: label += " - Failed to Save State"; break;
+            default: break;
+        }
+    }
     SetLabel(label);
 
     // Manage the main frame's partner frame
@@ -268,9 +349,12 @@ void NooFrame::Refresh()
 
 void NooFrame::runCore()
 {
-    // Run the emulator
+    // Run the emulator, stepping through rewind snapshots between frames
     while (running)
+    {
+        core->rewind.update();
         core->runFrame();
+    }
 }
 
 void NooFrame::checkSave()
@@ -459,6 +543,12 @@ void NooFrame::pressKey(int key)
             }
             break;
 
+        case 17: // Rewind Hold
+            // Step back through recent snapshots for as long as the key is held
+            if (running)
+                core->rewind.setRewinding(true);
+            break;
+
         default: // Core input
             // Send a key press to the core
             if (running)
@@ -488,6 +578,12 @@ void NooFrame::releaseKey(int key)
             hotkeyToggles &= ~BIT(key - 13);
             break;
 
+        case 17: // Rewind Hold
+            // Go back to running normally
+            if (running)
+                core->rewind.setRewinding(false);
+            break;
+
         default: // Core input
             // Send a key release to the core
             if (running)
@@ -601,8 +697,15 @@ void NooFrame::saveState(wxCommandEvent &event)
     if (dialog->ShowModal() == wxID_YES)
     {
         stopCore(false);
-        core->saveStates.saveState();
+        bool saved = core->saveStates.saveState();
         startCore(false);
+
+        // Show an error if the state couldn't be saved; failures while writing it are shown in the title
+        if (!saved)
+        {
+            wxMessageDialog error(this, "The state file couldn't be saved.", "Error", wxICON_NONE);
+            error.ShowModal();
+        }
     }
     delete dialog;
 }
@@ -735,6 +838,13 @@ void NooFrame::romInRam(wxCommandEvent &event)
     Settings::save();
 }
 
+void NooFrame::mmapRom(wxCommandEvent &event)
+{
+    // Toggle the memory-mapped ROM setting
+    Settings::mmapRom = !Settings::mmapRom;
+    Settings::save();
+}
+
 void NooFrame::micEnable(wxCommandEvent &event)
 {
     // Toggle the use microphone setting
@@ -792,6 +902,90 @@ void NooFrame::highRes3D(wxCommandEvent &event)
     Settings::save();
 }
 
+void NooFrame::arm9Jit(wxCommandEvent &event)
+{
+    // Toggle the ARM9 JIT setting
+    Settings::arm9Jit = !Settings::arm9Jit;
+    Settings::save();
+}
+
+void NooFrame::idleLoops(wxCommandEvent &event)
+{
+    // Toggle the idle loop skipping setting
+    Settings::idleLoops = !Settings::idleLoops;
+    Settings::save();
+}
+
+void NooFrame::fastmem(wxCommandEvent &event)
+{
+    // Toggle the JIT fastmem setting
+    Settings::fastmem = !Settings::fastmem;
+    Settings::save();
+}
+
+void NooFrame::rewind0(wxCommandEvent &event)
+{
+    // Set the rewind interval setting to disabled
+    Settings::rewindFrames = 0;
+    Settings::save();
+}
+
+void NooFrame::rewind1(wxCommandEvent &event)
+{
+    // Set the rewind interval setting to take snapshots every frame
+    Settings::rewindFrames = 1;
+    Settings::save();
+}
+
+void NooFrame::rewind5(wxCommandEvent &event)
+{
+    // Set the rewind interval setting to take snapshots every 5 frames
+    Settings::rewindFrames = 5;
+    Settings::save();
+}
+
+void NooFrame::rewind10(wxCommandEvent &event)
+{
+    // Set the rewind interval setting to take snapshots every 10 frames
+    Settings::rewindFrames = 10;
+    Settings::save();
+}
+
+void NooFrame::rewind30(wxCommandEvent &event)
+{
+    // Set the rewind interval setting to take snapshots every 30 frames
+    Settings::rewindFrames = 30;
+    Settings::save();
+}
+
+void NooFrame::rewindBuffer32(wxCommandEvent &event)
+{
+    // Set the rewind buffer setting to 32MB
+    Settings::rewindBudget = 32;
+    Settings::save();
+}
+
+void NooFrame::rewindBuffer64(wxCommandEvent &event)
+{
+    // Set the rewind buffer setting to 64MB
+    Settings::rewindBudget = 64;
+    Settings::save();
+}
+
+void NooFrame::rewindBuffer128(wxCommandEvent &event)
+{
+    // Set the rewind buffer setting to 128MB
+    Settings::rewindBudget = 128;
+    Settings::save();
+}
+
+void NooFrame::rewindBuffer256(wxCommandEvent &event)
+{
+    // Set the rewind buffer setting to 256MB
+    Settings::rewindBudget = 256;
+    Settings::save();
+}
+
 void NooFrame::updateJoystick(wxTimerEvent &event)
 {
     // Check the status of mapped joystick inputs and trigger key presses and releases accordingly
@@ -88,6 +88,7 @@ class NooFrame: public wxFrame
         void fpsLimiter(wxCommandEvent &event);
         void micEnable(wxCommandEvent &event);
         void romInRam(wxCommandEvent &event);
+        void mmapRom(wxCommandEvent &event);
         void threaded2D(wxCommandEvent &event);
         void threaded3D0(wxCommandEvent &event);
         void threaded3D1(wxCommandEvent &event);
@@ -95,6 +96,18 @@ class NooFrame: public wxFrame
         void threaded3D3(wxCommandEvent &event);
         void threaded3D4(wxCommandEvent &event);
         void highRes3D(wxCommandEvent &event);
+        void arm9Jit(wxCommandEvent &event);
+        void idleLoops(wxCommandEvent &event);
+        void fastmem(wxCommandEvent &event);
+        void rewind0(wxCommandEvent &event);
+        void rewind1(wxCommandEvent &event);
+        void rewind5(wxCommandEvent &event);
+        void rewind10(wxCommandEvent &event);
+        void rewind30(wxCommandEvent &event);
+        void rewindBuffer32(wxCommandEvent &event);
+        void rewindBuffer64(wxCommandEvent &event);
+        void rewindBuffer128(wxCommandEvent &event);
+        void rewindBuffer256(wxCommandEvent &event);
         void updateJoystick(wxTimerEvent &event);
         void dropFiles(wxDropFilesEvent &event);
         void close(wxCloseEvent &event);
@@ -17,16 +17,74 @@
     along with NooDS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <cstring>
 #include "dldi.h"
 #include "core.h"
 #include "settings.h"
 
+#ifdef MMAP_FILES
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 Dldi::~Dldi()
 {
     // Ensure the SD image is closed
+    closeImage();
+}
+
+void Dldi::closeImage()
+{
+    // Close the SD image file, unmapping it first
+    unmapImage();
     if (sdImage)
+    {
         fclose(sdImage);
+        sdImage = nullptr;
+    }
+}
+
+void Dldi::mapImage()
+{
+    // Get the size of the SD image, which requests are checked against
+    fflush(sdImage);
+#ifdef MMAP_FILES
+    struct stat st;
+    sdSize = fstat(fileno(sdImage), &st) ? 0 : std::max<int64_t>(st.st_size, 0);
+
+    // Try to map the SD image, so sectors can be copied without going through file reads
+    // Changes are shared with the file, letting the system cache and write them back
+    if (sdSize > 0 && sdSize <= SIZE_MAX)
+    {
+        void *data = mmap(nullptr, sdSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(sdImage), 0);
+        if (data != MAP_FAILED)
+            sdMap = (uint8_t*)data;
+    }
+#else
+    fseek(sdImage, 0, SEEK_END);
+    sdSize = std::max<long>(ftell(sdImage), 0);
+#endif
+}
+
+void Dldi::unmapImage()
+{
+#ifdef MMAP_FILES
+    // Write back changes to a mapped SD image before unmapping it
+    if (sdMap)
+    {
+        msync(sdMap, sdSize, MS_SYNC);
+        munmap(sdMap, sdSize);
+        sdMap = nullptr;
+    }
+#endif
+}
+
+bool Dldi::checkRequest(uint32_t numSectors, uint32_t buf, uint64_t &size)
+{
+    // Get the size of a request in bytes, rejecting ones larger than the SD image or past the end of memory
+    size = uint64_t(numSectors) << 9;
+    return sdImage && size <= sdSize && size <= uint64_t(0xFFFFFFFF) - buf;
 }
 
 void Dldi::patchRom(uint8_t *rom, uint32_t offset, uint32_t size)
@@ -86,9 +144,12 @@ void Dldi::patchRom(uint8_t *rom, uint32_t offset, uint32_t size)
 
 int Dldi::startup()
 {
-    // Try to open the SD image
+    // Try to open and map the SD image
+    closeImage();
     sdImage = fopen(Settings::sdImagePath.c_str(), "rb+");
-    return (sdImage ? 1 : 0);
+    if (!sdImage) return 0;
+    mapImage();
+    return 1;
 }
 
 int Dldi::isInserted()
@@ -100,39 +161,60 @@ int Dldi::isInserted()
 int Dldi::readSectors(bool arm7, uint32_t sector, uint32_t numSectors, uint32_t buf)
 {
     // Get the SD offset and size in bytes
-    if (!sdImage) return 0;
+    uint64_t size;
+    if (!checkRequest(numSectors, buf, size)) return 0;
     const uint64_t offset = uint64_t(sector) << 9;
-    const uint64_t size = uint64_t(numSectors) << 9;
 
-    // Read data from the SD image
-    uint8_t *data = new uint8_t[size];
+    if (sdMap)
+    {
+        // Copy data from the mapped SD image straight to memory, with zeros past the end
+        uint32_t length = (offset < sdSize) ? std::min(size, sdSize - offset) : 0;
+        core->memory.writeBlock(arm7, buf, sdMap + std::min(offset, sdSize), length);
+        if (length < size)
+        {
+            buffer.assign(size - length, 0);
+            core->memory.writeBlock(arm7, buf + length, buffer.data(), size - length);
+        }
+        return 1;
+    }
+
+    // Read data from the SD image into a reused buffer, with zeros past the end
+    if (buffer.size() < size) buffer.resize(size);
     fseek(sdImage, offset, SEEK_SET);
-    fread(data, sizeof(uint8_t), size, sdImage);
+    size_t length = fread(buffer.data(), sizeof(uint8_t), size, sdImage);
+    memset(&buffer[length], 0, size - length);
 
     // Write the data to memory
-    for (int i = 0; i < size; i++)
-        core->memory.write<uint8_t>(arm7, buf + i, data[i]);
-    delete[] data;
+    core->memory.writeBlock(arm7, buf, buffer.data(), size);
     return 1;
 }
 
 int Dldi::writeSectors(bool arm7, uint32_t sector, uint32_t numSectors, uint32_t buf)
 {
     // Get the SD offset and size in bytes
-    if (!sdImage) return 0;
+    uint64_t size;
+    if (!checkRequest(numSectors, buf, size)) return 0;
     const uint64_t offset = uint64_t(sector) << 9;
-    const uint64_t size = uint64_t(numSectors) << 9;
 
-    // Read data from memory
-    uint8_t *data = new uint8_t[size];
-    for (int i = 0; i < size; i++)
-        data[i] = core->memory.read<uint8_t>(arm7, buf + i);
+    if (sdMap && offset + size <= sdSize)
+    {
+        // Copy data from memory straight to the mapped SD image
+        core->memory.readBlock(arm7, buf, sdMap + offset, size);
+        return 1;
+    }
 
-    // Write the data to the SD image
+    // Read data from memory into a reused buffer
+    if (buffer.size() < size) buffer.resize(size);
+    core->memory.readBlock(arm7, buf, buffer.data(), size);
+
+    // Write the data to the SD image, growing it if the data goes past the end
+    // A mapped image is unmapped while it's written to, and mapped again at its new size
+    bool remap = (sdMap != nullptr);
+    unmapImage();
     fseek(sdImage, offset, SEEK_SET);
-    fwrite(data, sizeof(uint8_t), size, sdImage);
-    delete[] data;
-    return 1;
+    bool written = (fwrite(buffer.data(), sizeof(uint8_t), size, sdImage) == size);
+    if (remap || offset + size > sdSize) mapImage();
+    return written ? 1 : 0;
 }
 
 int Dldi::clearStatus()
@@ -143,9 +225,8 @@ int Dldi::clearStatus()
 
 int Dldi::shutdown()
 {
-    // Close the SD image
+    // Close the SD image, writing back any changes
     if (!sdImage) return 0;
-    fclose(sdImage);
-    sdImage = nullptr;
+    closeImage();
     return 1;
 }
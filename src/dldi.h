@@ -22,6 +22,7 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <vector>
 
 class Core;
 
@@ -55,6 +56,14 @@ class Dldi
         Core *core;
         bool patched = false;
         FILE *sdImage = nullptr;
+        uint8_t *sdMap = nullptr;
+        uint64_t sdSize = 0;
+        std::vector<uint8_t> buffer;
+
+        void closeImage();
+        void mapImage();
+        void unmapImage();
+        bool checkRequest(uint32_t numSectors, uint32_t buf, uint64_t &size);
 };
 
 #endif // DLDI_H
@@ -29,6 +29,7 @@ void Dma::saveState(MemFile &file)
     fwrite(dmaSad, 4, sizeof(dmaSad) / 4, file);
     fwrite(dmaDad, 4, sizeof(dmaDad) / 4, file);
     fwrite(dmaCnt, 4, sizeof(dmaCnt) / 4, file);
+    fwrite(&gxStalled, sizeof(gxStalled), 1, file);
 }
 
 void Dma::loadState(MemFile &file)
@@ -40,6 +41,7 @@ void Dma::loadState(MemFile &file)
     fread(dmaSad, 4, sizeof(dmaSad) / 4, file);
     fread(dmaDad, 4, sizeof(dmaDad) / 4, file);
     fread(dmaCnt, 4, sizeof(dmaCnt) / 4, file);
+    fread(&gxStalled, sizeof(gxStalled), 1, file);
 }
 
 void Dma::transfer(int channel)
@@ -48,6 +50,7 @@ void Dma::transfer(int channel)
     int srcAddrCnt = (dmaCnt[channel] & 0x01800000) >> 23;
     int mode       = (dmaCnt[channel] & 0x38000000) >> 27;
     int gxFifoCount = 0;
+    bool stalled = false;
 
     // Perform the transfer
     if (core->gbaMode && mode == 6 && (channel == 1 || channel == 2)) // GBA sound DMA
@@ -66,10 +69,59 @@ void Dma::transfer(int channel)
                 srcAddrs[channel] -= 4;
         }
     }
+    else if (mode != 7 && srcAddrCnt != 1 && (dstAddrCnt == 0 || dstAddrCnt == 3)) // Bulk transfer
+    {
+        // Copy runs of directly mapped memory at once, with an incrementing or fixed source
+        // Anything that can't be copied directly, like I/O or multi-mapped VRAM, is transferred an element at a time
+        uint32_t size = (dmaCnt[channel] & BIT(26)) ? 4 : 2;
+        for (uint32_t i = 0; i < wordCounts[channel];)
+        {
+            uint32_t count = core->memory.copyBlock(cpu, dstAddrs[channel],
+                srcAddrs[channel], wordCounts[channel] - i, size, srcAddrCnt != 0);
+
+            if (count == 0)
+            {
+                // Stop if the geometry FIFO is full, and continue from here once it has space
+                if (gxFull(dstAddrs[channel]))
+                {
+                    wordCounts[channel] -= i;
+                    stalled = true;
+                    break;
+                }
+
+                // Transfer a single word or half-word
+                if (size == 4)
+                {
+                    uint32_t value = core->memory.read<uint32_t>(cpu, srcAddrs[channel], false);
+                    core->memory.write<uint32_t>(cpu, dstAddrs[channel], value, false);
+                }
+                else
+                {
+                    uint16_t value = core->memory.read<uint16_t>(cpu, srcAddrs[channel], false);
+                    core->memory.write<uint16_t>(cpu, dstAddrs[channel], value, false);
+                }
+                count = 1;
+            }
+
+            // Adjust the addresses past the transferred run
+            if (srcAddrCnt == 0) // Increment
+                srcAddrs[channel] += count * size;
+            dstAddrs[channel] += count * size;
+            i += count;
+        }
+    }
     else if (dmaCnt[channel] & BIT(26)) // Whole word transfer
     {
         for (unsigned int i = 0; i < wordCounts[channel]; i++)
         {
+            // Stop if the geometry FIFO is full, and continue from here once it has space
+            if (gxFull(dstAddrs[channel]))
+            {
+                if (mode != 7) wordCounts[channel] -= i;
+                stalled = true;
+                break;
+            }
+
             // Transfer a word
             uint32_t value = core->memory.read<uint32_t>(cpu, srcAddrs[channel], false);
             core->memory.write<uint32_t>(cpu, dstAddrs[channel], value, false);
@@ -95,6 +147,14 @@ void Dma::transfer(int channel)
     {
         for (unsigned int i = 0; i < wordCounts[channel]; i++)
         {
+            // Stop if the geometry FIFO is full, and continue from here once it has space
+            if (gxFull(dstAddrs[channel]))
+            {
+                if (mode != 7) wordCounts[channel] -= i;
+                stalled = true;
+                break;
+            }
+
             // Transfer a half-word
             uint16_t value = core->memory.read<uint16_t>(cpu, srcAddrs[channel], false);
             core->memory.write<uint16_t>(cpu, dstAddrs[channel], value, false);
@@ -117,6 +177,17 @@ void Dma::transfer(int channel)
         }
     }
 
+    if (stalled)
+    {
+        // Halt the CPU like a write to the full FIFO would, and wait there for an entry to be executed
+        // The transfer continues as soon as there's space, so the CPU resumes when the last words fit, as if they
+        // had all been written at once; it can't see the transfer in the meantime, so its timing isn't affected
+        if (mode == 7) wordCounts[channel] -= gxFifoCount;
+        gxStalled |= BIT(channel);
+        core->interpreter[0].halt(1);
+        return;
+    }
+
     if (mode == 7)
     {
         // Don't end a GXFIFO transfer if there are still words left
@@ -152,6 +223,24 @@ void Dma::transfer(int channel)
         core->interpreter[cpu].sendInterrupt(8 + channel);
 }
 
+void Dma::resumeGx()
+{
+    // Continue transfers that were waiting for the geometry FIFO to have space
+    for (int i = 0; i < 4; i++)
+    {
+        if (!(gxStalled & BIT(i))) continue;
+        gxStalled &= ~BIT(i);
+        transfer(i);
+    }
+}
+
+bool Dma::gxFull(uint32_t address)
+{
+    // Check if a transfer to the ARM9's geometry command ports has to wait for the FIFO to have space
+    // Holding transfers back here keeps the FIFO from growing past its size, like it does on hardware
+    return cpu == 0 && (address & ~0x1FF) == 0x4000400 && (core->gpu3D.readGxStat() & BIT(24));
+}
+
 void Dma::trigger(int mode, uint8_t channels)
 {
     // ARM7 DMAs don't use the lowest mode bit, so adjust accordingly
@@ -165,6 +254,37 @@ void Dma::trigger(int mode, uint8_t channels)
     }
 }
 
+int Dma::streamChannel(int mode)
+{
+    // ARM7 DMAs don't use the lowest mode bit, so adjust accordingly
+    if (cpu == 1) mode <<= 1;
+
+    // Find the channel that would be triggered in a mode, if there's only one
+    int channel = -1;
+    for (int i = 0; i < 4; i++)
+    {
+        if (!(dmaCnt[i] & BIT(31)) || ((dmaCnt[i] & 0x38000000) >> 27) != mode) continue;
+        if (channel >= 0) return -1;
+        channel = i;
+    }
+
+    // Only allow streaming to a channel that repeatedly transfers a word from the DS cart to incrementing addresses
+    // Anything else, like a channel with an IRQ for each transfer, still has to be triggered for every word
+    if (channel < 0 || (dmaCnt[channel] & 0x47FFFFFF) != 0x07000001 || wordCounts[channel] != 1 || srcAddrs[channel] != 0x4100010)
+        return -1;
+    return channel;
+}
+
+void Dma::streamWords(int channel, uint32_t *words, uint32_t count)
+{
+    // Write words as if the channel was triggered for each one, with its word count reloaded on repeat
+    for (uint32_t i = 0; i < count; i++)
+    {
+        core->memory.write<uint32_t>(cpu, dstAddrs[channel], words[i], false);
+        dstAddrs[channel] += 4;
+    }
+}
+
 void Dma::writeDmaSad(int channel, uint32_t mask, uint32_t value)
 {
     // Write to one of the DMASAD registers
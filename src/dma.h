@@ -36,6 +36,10 @@ class Dma
 
         void transfer(int channel);
         void trigger(int mode, uint8_t channels = 0xF);
+        int streamChannel(int mode);
+        void streamWords(int channel, uint32_t *words, uint32_t count);
+        void resumeGx();
+        bool isGxStalled() { return gxStalled; }
 
         uint32_t readDmaSad(int channel) { return dmaSad[channel]; }
         uint32_t readDmaDad(int channel) { return dmaDad[channel]; }
@@ -56,6 +60,9 @@ class Dma
         uint32_t dmaSad[4] = {};
         uint32_t dmaDad[4] = {};
         uint32_t dmaCnt[4] = {};
+        uint8_t gxStalled = 0;
+
+        bool gxFull(uint32_t address);
 };
 
 #endif // DMA_H
@@ -255,6 +255,23 @@ bool Gpu::getFrame(uint32_t *out, bool gbaCrop)
     return true;
 }
 
+bool Gpu::dropFrame()
+{
+    // Check if a new frame is ready
+    if (!ready.load())
+        return false;
+
+    // Remove the next queued frame without drawing it, for frames that won't be shown
+    mutex.lock();
+    Buffers &buffers = framebuffers.front();
+    delete[] buffers.framebuffer;
+    delete[] buffers.hiRes3D;
+    framebuffers.pop();
+    ready.store(!framebuffers.empty());
+    mutex.unlock();
+    return true;
+}
+
 void Gpu::gbaScanline240()
 {
     if (vCount < 160)
@@ -268,6 +285,7 @@ void Gpu::gbaScanline240()
         else
         {
             // Draw the current scanline
+            PROFILE_SCOPE(core, PROFILE_GPU_2D);
             core->gpu2D[0].drawGbaScanline(vCount);
         }
 
@@ -405,6 +423,7 @@ void Gpu::scanline256()
         else
         {
             // Draw the current scanlines
+            PROFILE_SCOPE(core, PROFILE_GPU_2D);
             core->gpu2D[0].drawScanline(vCount);
             core->gpu2D[1].drawScanline(vCount);
         }
@@ -525,6 +544,7 @@ void Gpu::scanline256()
     // Bit 0 of the dirty variable represents invalidation, and bit 1 represents a frame currently drawing
     if (dirty3D && (core->gpu2D[0].readDispCnt() & BIT(3)) && ((vCount + 48) % 263) < 192)
     {
+        PROFILE_SCOPE(core, PROFILE_RENDER_3D);
         if (vCount == 215) dirty3D = BIT(1);
         core->gpu3DRenderer.drawScanline((vCount + 48) % 263);
         if (vCount == 143) dirty3D &= ~BIT(1);
@@ -678,6 +698,8 @@ void Gpu::scanline355()
 
 void Gpu::drawGbaThreaded()
 {
+    Tracer::setThreadName("2D Renderer");
+
     while (running)
     {
         // Wait until the next scanline should start
@@ -697,6 +719,8 @@ void Gpu::drawGbaThreaded()
 
 void Gpu::drawThreaded()
 {
+    Tracer::setThreadName("2D Renderer");
+
     while (running)
     {
         // Wait until the next scanline should start
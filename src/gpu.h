@@ -41,6 +41,7 @@ class Gpu
         void loadState(MemFile &file);
 
         bool getFrame(uint32_t *out, bool gbaCrop);
+        bool dropFrame();
         void invalidate3D() { dirty3D |= BIT(0); }
 
         void gbaScanline240();
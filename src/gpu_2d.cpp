@@ -122,6 +122,8 @@ void Gpu2D::updateWindows(int line)
 
 void Gpu2D::drawGbaScanline(int line)
 {
+    TRACE_SCOPE("2D Scanline");
+
     // Clear layers with the backdrop (first palette index)
     uint32_t backdrop = U8TO16(palette, 0) & ~BIT(15);
     for (int i = 0; i < 240; i++) layers[0][i] = backdrop;
@@ -242,6 +244,8 @@ void Gpu2D::drawGbaScanline(int line)
 
 void Gpu2D::drawScanline(int line)
 {
+    TRACE_SCOPE("2D Scanline");
+
     // Clear layers with the backdrop (first palette index)
     uint32_t backdrop = U8TO16(palette, 0) & ~BIT(15);
     for (int i = 0; i < 256; i++) layers[0][i] = backdrop;
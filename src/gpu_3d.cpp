@@ -23,6 +23,11 @@
 #include "core.h"
 #include "settings.h"
 
+// Number of FIFO entries to reserve room for in states
+// This covers a full FIFO and pipe, plus entries written while the CPU is being halted
+// DMAs wait for space before each word, so they can only add a word's worth of packed commands past full
+#define GX_STATE_ENTRIES 0x400
+
 Matrix Matrix::operator*(Matrix &mtx)
 {
     Matrix result;
@@ -220,6 +225,12 @@ void Gpu3D::loadState(MemFile &file)
     }
 }
 
+uint32_t Gpu3D::getStatePadding()
+{
+    // Get the space needed to fill the FIFO to its reserved size in states
+    return (fifo.size() < GX_STATE_ENTRIES) ? (GX_STATE_ENTRIES - fifo.size()) * sizeof(Entry) : 0;
+}
+
 uint32_t Gpu3D::rgb5ToRgb6(uint16_t color)
 {
     // Convert an RGB5 value to an RGB6 value (the way the 3D engine does it)
@@ -314,6 +325,9 @@ bool Gpu3D::clipPolygon(Vertex *unclipped, Vertex *clipped, uint8_t *size)
 
 void Gpu3D::runCommand()
 {
+    PROFILE_SCOPE(core, PROFILE_GPU_3D);
+    PROFILE_COUNT(core, gxCommands);
+
     // Fetch the next geometry command
     Entry entry = fifo.front();
     int count = paramCounts[entry.command];
@@ -409,8 +423,12 @@ void Gpu3D::runCommand()
         case 2: if (gxStat & BIT(26)) core->interpreter[0].sendInterrupt(21); break;
     }
 
-    // Unhalt the CPU if the FIFO was full but now has space free
-    if (fifo.size() - pipeSize <= 256)
+    // Continue DMAs that were waiting for the FIFO to have space, which can fill it again
+    if (fifo.size() - pipeSize < 256 && core->dma[0].isGxStalled())
+        core->dma[0].resumeGx();
+
+    // Unhalt the CPU if the FIFO was full but now has space free, unless a DMA is still waiting
+    if (fifo.size() - pipeSize <= 256 && !core->dma[0].isGxStalled())
         core->interpreter[0].unhalt(1);
 
     // Keep executing commands as long as they're ready
@@ -454,6 +472,8 @@ void Gpu3D::processVertices()
 
 void Gpu3D::swapBuffers()
 {
+    PROFILE_SCOPE(core, PROFILE_GPU_3D);
+
     // Process final vertices and reset the count
     processVertices();
     processCount = 0;
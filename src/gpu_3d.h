@@ -109,6 +109,7 @@ class Gpu3D
         Gpu3D(Core *core): core(core) {}
         void saveState(MemFile &file);
         void loadState(MemFile &file);
+        uint32_t getStatePadding();
 
         void runCommand();
         void swapBuffers();
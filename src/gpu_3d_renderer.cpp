@@ -195,6 +195,8 @@ void Gpu3DRenderer::drawScanline(int line)
 
 void Gpu3DRenderer::drawThreaded(int thread)
 {
+    Tracer::setThreadName("3D Renderer");
+
     // Draw the 3D scanlines in a threaded sequence
     // The amount of scanlines skipped per thread depends on the number of active threads
     // Together, they render the entire 3D image
@@ -240,6 +242,8 @@ void Gpu3DRenderer::drawThreaded(int thread)
 
 void Gpu3DRenderer::drawScanline1(int line)
 {
+    TRACE_SCOPE("3D Scanline");
+
     // Convert the clear values
     // The attribute buffer contains the polygon IDs (0-5, 6-11), transparency bit (12), fog bit (13), edge bit (14), and edge alpha (15-20)
     uint32_t color = BIT(26) | rgba5ToRgba6(((clearColor & 0x001F0000) >> 1) | (clearColor & 0x00007FFF));
@@ -282,6 +286,8 @@ void Gpu3DRenderer::drawScanline1(int line)
 
 void Gpu3DRenderer::finishScanline(int line)
 {
+    TRACE_SCOPE("3D Finish");
+
     // Perform edge marking if enabled
     if (disp3DCnt & BIT(5))
     {
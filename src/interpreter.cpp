@@ -19,6 +19,7 @@
 
 #include "interpreter.h"
 #include "core.h"
+#include "settings.h"
 
 Interpreter::Interpreter(Core *core, bool arm7): core(core), arm7(arm7)
 {
@@ -52,7 +53,7 @@ void Interpreter::saveState(MemFile &file)
     fwrite(&postFlg, sizeof(postFlg), 1, file);
 }
 
-void Interpreter::loadState(MemFile &file)
+void Interpreter::loadState(MemFile &file, bool oldCycles)
 {
     // Read state data from the file
     fread(pipeline, 4, sizeof(pipeline) / 4, file);
@@ -68,7 +69,17 @@ void Interpreter::loadState(MemFile &file)
     fread(&spsrAbt, sizeof(spsrAbt), 1, file);
     fread(&spsrIrq, sizeof(spsrIrq), 1, file);
     fread(&spsrUnd, sizeof(spsrUnd), 1, file);
-    fread(&cycles, sizeof(cycles), 1, file);
+    if (oldCycles)
+    {
+        // Widen the cycles from old states that stored them as 32-bit
+        uint32_t cycles32 = 0;
+        fread(&cycles32, sizeof(cycles32), 1, file);
+        cycles = cycles32;
+    }
+    else
+    {
+        fread(&cycles, sizeof(cycles), 1, file);
+    }
     fread(&halted, sizeof(halted), 1, file);
     fread(&dsiCycle, sizeof(dsiCycle), 1, file);
     fread(&ime, sizeof(ime), 1, file);
@@ -76,8 +87,12 @@ void Interpreter::loadState(MemFile &file)
     fread(&irf, sizeof(irf), 1, file);
     fread(&postFlg, sizeof(postFlg), 1, file);
 
-    // Update mapped registers
+    // Forget the last idle loop check, since the loaded code might be different
+    resetIdle();
+
+    // Update mapped registers and stop running from the block cache
     swapRegisters(cpsr);
+    blockOp = nullptr;
 }
 
 void Interpreter::init()
@@ -106,43 +121,59 @@ void Interpreter::directBoot()
     flushPipeline();
 }
 
-void Interpreter::resetCycles()
-{
-    // Adjust CPU cycles for a global cycle reset
-    cycles -= std::min(core->globalCycles, cycles);
-}
-
 void Interpreter::runNdsFrame(Core &core)
 {
-    // Run a frame in NDS mode
+    // Run a frame in NDS mode, with the ARM9 JIT if enabled
     Interpreter &arm9 = core.interpreter[0];
     Interpreter &arm7 = core.interpreter[1];
+    bool jit = Settings::arm9Jit;
     while (core.running.exchange(true))
     {
         // Run the CPUs until the next scheduled task
-        while (core.events[0].cycles > core.globalCycles)
+        while (core.nextCycles > core.globalCycles)
         {
-            // Run the ARM9
+            // Run the ARM9, continuing for as long as it would be the only thing to run
             if (!arm9.halted && core.globalCycles >= arm9.cycles)
-                arm9.cycles = core.globalCycles + arm9.runOpcode();
+            {
+                while (true)
+                {
+                    // Compiled blocks leave the cycle counts as if their last instruction was run on its own
+                    if (!jit || !core.jit.runArm9())
+                    {
+                        arm9.cycles = core.globalCycles + arm9.runOpcode();
+                        PROFILE_OPCODE(&core, 0, arm9.cycles - core.globalCycles);
+                    }
+                    if (arm9.halted || arm9.cycles >= core.nextCycles || (!arm7.halted && arm9.cycles >= arm7.cycles)) break;
+                    core.globalCycles = arm9.cycles;
+                }
+            }
 
-            // Run the ARM7 at half the speed of the ARM9
+            // Run the ARM7 at half the speed of the ARM9, continuing the same way
             if (!arm7.halted && core.globalCycles >= arm7.cycles)
-                arm7.cycles = core.globalCycles + (arm7.runOpcode() << 1);
+            {
+                while (true)
+                {
+                    arm7.cycles = core.globalCycles + (arm7.runOpcode() << 1);
+                    PROFILE_OPCODE(&core, 1, arm7.cycles - core.globalCycles);
+                    if (arm7.halted || arm7.cycles >= core.nextCycles || (!arm9.halted && arm7.cycles >= arm9.cycles)) break;
+                    core.globalCycles = arm7.cycles;
+                }
+            }
 
             // Count cycles up to the next soonest event
-            core.globalCycles = std::min<uint32_t>((arm9.halted ? -1 : arm9.cycles), (arm7.halted ? -1 : arm7.cycles));
+            core.globalCycles = std::min<uint64_t>((arm9.halted ? -1 : arm9.cycles), (arm7.halted ? -1 : arm7.cycles));
         }
 
         // Jump to the next scheduled task
-        core.globalCycles = core.events[0].cycles;
+        core.globalCycles = core.nextCycles;
 
         // Run all tasks that are scheduled now
-        while (core.events[0].cycles <= core.globalCycles)
-        {
-            core.tasks[core.events[0].task]();
-            core.events.erase(core.events.begin());
-        }
+        while (core.nextCycles <= core.globalCycles)
+            core.runTask(core.nextTask());
+
+        // Wake CPUs that are skipping idle loops, since the tasks might have changed what they wait on
+        arm9.wakeIdle();
+        arm7.wakeIdle();
     }
 }
 
@@ -154,33 +185,48 @@ void Interpreter::runDsiFrame(Core &core)
     while (core.running.exchange(true))
     {
         // Run the CPUs until the next scheduled task
-        while (core.events[0].cycles > core.globalCycles)
+        while (core.nextCycles > core.globalCycles)
         {
-            // Run the ARM9 twice as fast as usual
+            // Run the ARM9 twice as fast as usual, continuing for as long as it would be the only thing to run
             if (!arm9.halted && core.globalCycles >= arm9.cycles)
             {
-                int cycles = arm9.runOpcode() + arm9.dsiCycle;
-                arm9.cycles = core.globalCycles + (cycles >> 1);
-                arm9.dsiCycle = (cycles & 0x1);
+                while (true)
+                {
+                    int cycles = arm9.runOpcode() + arm9.dsiCycle;
+                    arm9.cycles = core.globalCycles + (cycles >> 1);
+                    arm9.dsiCycle = (cycles & 0x1);
+                    PROFILE_OPCODE(&core, 0, cycles >> 1);
+                    if (arm9.halted || arm9.cycles >= core.nextCycles || (!arm7.halted && arm9.cycles >= arm7.cycles)) break;
+                    core.globalCycles = arm9.cycles;
+                }
             }
 
-            // Run the ARM7 at half the regular speed of the ARM9
+            // Run the ARM7 at half the regular speed of the ARM9, continuing the same way
             if (!arm7.halted && core.globalCycles >= arm7.cycles)
-                arm7.cycles = core.globalCycles + (arm7.runOpcode() << 1);
+            {
+                while (true)
+                {
+                    arm7.cycles = core.globalCycles + (arm7.runOpcode() << 1);
+                    PROFILE_OPCODE(&core, 1, arm7.cycles - core.globalCycles);
+                    if (arm7.halted || arm7.cycles >= core.nextCycles || (!arm9.halted && arm7.cycles >= arm9.cycles)) break;
+                    core.globalCycles = arm7.cycles;
+                }
+            }
 
             // Count cycles up to the next soonest event
-            core.globalCycles = std::min<uint32_t>((arm9.halted ? -1 : arm9.cycles), (arm7.halted ? -1 : arm7.cycles));
+            core.globalCycles = std::min<uint64_t>((arm9.halted ? -1 : arm9.cycles), (arm7.halted ? -1 : arm7.cycles));
         }
 
         // Jump to the next scheduled task
-        core.globalCycles = core.events[0].cycles;
+        core.globalCycles = core.nextCycles;
 
         // Run all tasks that are scheduled now
-        while (core.events[0].cycles <= core.globalCycles)
-        {
-            core.tasks[core.events[0].task]();
-            core.events.erase(core.events.begin());
-        }
+        while (core.nextCycles <= core.globalCycles)
+            core.runTask(core.nextTask());
+
+        // Wake CPUs that are skipping idle loops, since the tasks might have changed what they wait on
+        arm9.wakeIdle();
+        arm7.wakeIdle();
     }
 }
 
@@ -192,23 +238,51 @@ void Interpreter::runGbaFrame(Core &core)
     {
         // Run the ARM7 until the next scheduled task
         if (arm7.cycles > core.globalCycles) core.globalCycles = arm7.cycles;
-        while (!arm7.halted && core.events[0].cycles > arm7.cycles)
-            arm7.cycles = (core.globalCycles += arm7.runOpcode());
+        while (!arm7.halted && core.nextCycles > arm7.cycles)
+        {
+            int cycles = arm7.runOpcode();
+            PROFILE_OPCODE(&core, 1, cycles);
+            arm7.cycles = (core.globalCycles += cycles);
+        }
 
         // Jump to the next scheduled task
-        core.globalCycles = core.events[0].cycles;
+        core.globalCycles = core.nextCycles;
 
         // Run all tasks that are scheduled now
-        while (core.events[0].cycles <= core.globalCycles)
-        {
-            core.tasks[core.events[0].task]();
-            core.events.erase(core.events.begin());
-        }
+        while (core.nextCycles <= core.globalCycles)
+            core.runTask(core.nextTask());
+
+        // Wake the CPU if it's skipping an idle loop, since the tasks might have changed what it waits on
+        arm7.wakeIdle();
     }
 }
 
 FORCE_INLINE int Interpreter::runOpcode()
 {
+    // Run from the block cache if possible, which skips fetching and decoding opcodes
+    if (blockOp || (blockOp = findBlock()))
+    {
+        // Push the next opcode through the pipeline, filling it from the block's prefetched opcodes
+        CachedOpcode &op = *blockOp;
+        pipeline[0] = pipeline[1];
+        pipeline[1] = blockOp[2].opcode;
+        if (++blockOp == blockEnd)
+            blockOp = nullptr;
+
+        // Execute a pre-decoded THUMB instruction
+        if (cpsr & BIT(5))
+        {
+            *registers[15] += 2;
+            return (this->*op.thumb)(op.opcode);
+        }
+
+        // Execute a pre-decoded ARM instruction based on its condition
+        *registers[15] += 4;
+        if (!condition[((op.opcode >> 24) & 0xF0) | (cpsr >> 28)])
+            return 1;
+        return (this->*op.arm)(op.opcode);
+    }
+
     // Push the next opcode through the pipeline
     uint32_t opcode = pipeline[0];
     pipeline[0] = pipeline[1];
@@ -278,8 +352,342 @@ int Interpreter::exception(uint8_t vector)
     return 3;
 }
 
+Interpreter::CachedOpcode *Interpreter::findBlock()
+{
+    // Look up the cached block starting at the current instruction, building it if it's missing
+    bool thumb = (cpsr & BIT(5));
+    uint32_t address = *registers[15] - (thumb ? 2 : 4);
+    CachedBlock &block = blocks[(address >> (thumb ? 1 : 2)) & (CACHE_BLOCKS - 1)];
+    if ((!block.data || block.address != (address | thumb)) && !buildBlock(block, address, thumb))
+        return nullptr;
+
+    // Only use the block if it matches the pipeline, which can hold stale opcodes after code is modified
+    CachedOpcode *opcodes = blockOpcodes[&block - blocks];
+    if (opcodes[0].opcode != pipeline[0] || opcodes[1].opcode != pipeline[1])
+        return nullptr;
+
+    blockEnd = &opcodes[block.count];
+    return opcodes;
+}
+
+bool Interpreter::isJump(uint32_t opcode, bool thumb)
+{
+    // Check if an opcode can change the program counter non-sequentially, not counting exceptions
+    if (thumb)
+        return ((opcode & 0xF000) == 0xD000) || ((opcode & 0xF800) == 0xE000) || ((opcode & 0xE800) == 0xE800) ||
+            ((opcode & 0xFF00) == 0x4700) || ((opcode & 0xFF00) == 0xBD00) || ((opcode & 0xFC87) == 0x4487);
+    return ((opcode >> 28) == 0xF) || ((opcode & 0x0E000000) == 0x0A000000) || ((opcode & 0x0F000000) == 0x0F000000) ||
+        ((opcode & 0x0FFFFFD0) == 0x012FFF10) || ((opcode & 0x0E108000) == 0x08108000) ||
+        ((opcode & 0x0C00F000) == 0x0000F000) || ((opcode & 0x0C10F000) == 0x0410F000);
+}
+
+bool Interpreter::buildBlock(CachedBlock &block, uint32_t address, bool thumb)
+{
+    // Get the memory to decode from, if code there can be cached
+    uint8_t *data = core->memory.getCodePointer(arm7, address);
+    if (!data) return false;
+    data += address & 0xFFF;
+
+    // Decode opcodes until a possible jump or the end of the memory block, plus 2 more to fill the pipeline
+    CachedOpcode *opcodes = blockOpcodes[&block - blocks];
+    uint32_t width = thumb ? 2 : 4;
+    int count = 0, end = BLOCK_OPCODES;
+    while (count < end && (address & 0xFFF) + count * width < 0x1000)
+    {
+        uint32_t opcode = 0;
+        for (uint32_t i = 0; i < width; i++)
+            opcode |= data[count * width + i] << (i * 8);
+
+        CachedOpcode &op = opcodes[count++];
+        op.opcode = opcode;
+
+        if (thumb)
+            op.thumb = thumbInstrs[(opcode >> 6) & 0x3FF];
+        else if ((opcode >> 28) == 0xF) // Reserved condition
+            op.arm = &Interpreter::handleReserved;
+        else
+            op.arm = armInstrs[((opcode >> 16) & 0xFF0) | ((opcode >> 4) & 0xF)];
+
+        // Stop decoding after the pipeline opcodes following a jump
+        if (isJump(opcode, thumb) && end == BLOCK_OPCODES)
+            end = std::min(count + 2, int(BLOCK_OPCODES));
+    }
+
+    // Give up if there aren't enough opcodes to both run and fill the pipeline
+    if (count < 3) return false;
+
+    // Track the decoded memory so writes to it drop the block
+    block.address = address | thumb;
+    block.data = data;
+    block.size = count * width;
+    block.count = count - 2;
+    core->memory.markCode(data, block.size);
+    return true;
+}
+
+void Interpreter::invalidateBlocks(uint8_t *start, uint8_t *end)
+{
+    // Forget the last idle loop check, since its code might have been written over
+    resetIdle();
+
+    // Drop cached blocks decoded from memory that was written to, including one that's running
+    for (int i = 0; i < CACHE_BLOCKS; i++)
+    {
+        CachedBlock &block = blocks[i];
+        if (!block.data || block.data >= end || block.data + block.size <= start)
+            continue;
+        if (blockOp && blockOp >= blockOpcodes[i] && blockOp < blockOpcodes[i] + BLOCK_OPCODES)
+            blockOp = nullptr;
+        block.data = nullptr;
+    }
+}
+
+void Interpreter::flushBlocks(uint32_t start, uint32_t end)
+{
+    // Forget the last idle loop check, since different code might be mapped in its place
+    resetIdle();
+
+    // Drop cached blocks in an address range whose memory mapping changed, including one that's running
+    for (int i = 0; i < CACHE_BLOCKS; i++)
+    {
+        CachedBlock &block = blocks[i];
+        uint32_t address = block.address & ~0x1;
+        if (!block.data || address < start || address >= end)
+            continue;
+        if (blockOp && blockOp >= blockOpcodes[i] && blockOp < blockOpcodes[i] + BLOCK_OPCODES)
+            blockOp = nullptr;
+        block.data = nullptr;
+    }
+}
+
+int Interpreter::checkIdle(int32_t offset)
+{
+    // Only check short loops, and only if idle loop skipping is enabled
+    bool thumb = (cpsr & BIT(5));
+    uint32_t width = thumb ? 2 : 4;
+    uint32_t size = -offset - width * 2;
+    if (size >= IDLE_LOOP_SIZE || !Settings::idleLoops) return 3;
+
+    // Decode a loop when it's first seen to check if it could be idle
+    uint32_t start = *registers[15] - width;
+    if (idleLoop != (start | thumb))
+    {
+        idleLoop = start | thumb;
+        idleSafe = decodeIdleLoop(start, start + size, thumb);
+        idleChanged = true;
+        core->memory.clearIdleWatch(arm7);
+    }
+    if (!idleSafe) return 3;
+
+    // Skip ahead if the loop came back to the same state without jumping elsewhere or its memory changing
+    // Nothing the loop does can change its state again until something else does, which wakes the CPU
+    if (!idleChanged && jumps == idleJumps + 1 && cpsr == idleCpsr)
+    {
+        int i = 0;
+        while (i < 16 && *registers[i] == idleRegs[i]) i++;
+        if (i == 16)
+        {
+            halted |= BIT(2);
+            return 3;
+        }
+    }
+
+    // Save the state at the start of an iteration, and watch the memory it will read
+    idleChanged = false;
+    idleJumps = jumps;
+    idleCpsr = cpsr;
+    for (int i = 0; i < 16; i++)
+        idleRegs[i] = *registers[i];
+    if (!watchIdleLoop())
+    {
+        idleSafe = false;
+        core->memory.clearIdleWatch(arm7);
+    }
+    return 3;
+}
+
+bool Interpreter::decodeIdleLoop(uint32_t start, uint32_t end, bool thumb, bool save)
+{
+    // Check that a loop only reads memory and sets registers, tracking where each load reads from
+    // Load addresses can be worked out from the saved state as long as their registers are set at most once per loop
+    IdleLoad loads[IDLE_LOOP_SIZE / 2];
+    uint8_t writes[16] = {};
+    int count = 0;
+
+    for (uint32_t address = start; address < end; address += (thumb ? 2 : 4))
+    {
+        IdleLoad load = { -1, -1, 0, 0 };
+        if (thumb)
+        {
+            uint16_t op = core->memory.read<uint16_t>(arm7, address);
+            if (op < 0x2000) // Shifts and add/sub
+                writes[op & 0x7]++;
+            else if (op < 0x4000) // Immediate MOV/CMP/ADD/SUB
+                writes[(op >> 8) & 0x7] += ((op & 0x1800) != 0x0800);
+            else if (op < 0x4400) // ALU operations
+                writes[op & 0x7] += ((op & 0x0300) != 0x0200 || (op & 0x00C0) == 0x0040);
+            else if (op < 0x4700) // High register ADD/CMP/MOV
+            {
+                int rd = ((op >> 4) & 0x8) | (op & 0x7);
+                if ((op & 0x0300) == 0x0100) continue;
+                if (rd == 15) return false;
+                writes[rd]++;
+            }
+            else if (op >= 0x4800 && op < 0x5000) // LDR Rd,[PC,#i]
+            {
+                load.offset = ((address + 4) & ~0x3) + ((op & 0xFF) << 2);
+                writes[(op >> 8) & 0x7]++;
+                loads[count++] = load;
+            }
+            else if (op >= 0x5600 && op < 0x6000) // Loads with register offsets
+            {
+                load.base = (op >> 3) & 0x7;
+                load.index = (op >> 6) & 0x7;
+                writes[op & 0x7]++;
+                loads[count++] = load;
+            }
+            else if ((op & 0xE800) == 0x6800 || (op & 0xF800) == 0x8800) // Loads with immediate offsets
+            {
+                load.base = (op >> 3) & 0x7;
+                load.offset = ((op >> 6) & 0x1F) << ((op & 0x9000) == 0x8000 ? 1 : (op & 0x1000) ? 0 : 2);
+                writes[op & 0x7]++;
+                loads[count++] = load;
+            }
+            else if ((op & 0xF800) == 0x9800) // LDR Rd,[SP,#i]
+            {
+                load.base = 13;
+                load.offset = (op & 0xFF) << 2;
+                writes[(op >> 8) & 0x7]++;
+                loads[count++] = load;
+            }
+            else if ((op & 0xF000) == 0xA000) // ADD Rd,PC/SP,#i
+                writes[(op >> 8) & 0x7]++;
+            else if (((op & 0xF000) != 0xD000 || (op & 0x0F00) >= 0x0E00) && (op & 0xF800) != 0xE000) // Not a branch
+                return false;
+        }
+        else
+        {
+            uint32_t op = core->memory.read<uint32_t>(arm7, address);
+            int rd = (op >> 12) & 0xF;
+            if ((op >> 28) == 0xF) // Reserved condition
+                return false;
+            else if ((op & 0x0F000000) == 0x0A000000) // B label
+                continue;
+            else if ((op & 0x0E000090) == 0x00000090 && (op & 0x02000060)) // Halfword and signed transfers
+            {
+                // Only allow loads with pre-indexing and no writeback
+                if ((op & 0x01300000) != 0x01100000 || rd == 15) return false;
+                load.base = (op >> 16) & 0xF;
+                if (op & BIT(22))
+                    load.offset = ((op >> 4) & 0xF0) | (op & 0xF);
+                else if (op & BIT(23))
+                    load.index = op & 0xF;
+                else
+                    return false;
+                if (!(op & BIT(23))) load.offset = -load.offset;
+                writes[rd]++;
+                loads[count++] = load;
+            }
+            else if ((op & 0x0C000000) == 0x00000000 && ((op & 0x02000000) || (op & 0x90) != 0x90)) // Data processing
+            {
+                // Test opcodes without the S bit are other instructions, like MRS and MSR
+                int alu = (op >> 21) & 0xF;
+                if (alu >= 0x8 && alu <= 0xB)
+                {
+                    if (!(op & BIT(20))) return false;
+                    continue;
+                }
+                if (rd == 15) return false;
+                writes[rd]++;
+            }
+            else if ((op & 0x0C000000) == 0x04000000) // Single data transfers
+            {
+                // Only allow loads with pre-indexing, no writeback, and added register offsets shifted left
+                if ((op & 0x01300000) != 0x01100000 || rd == 15) return false;
+                load.base = (op >> 16) & 0xF;
+                if (op & BIT(25))
+                {
+                    if ((op & 0x00800070) != 0x00800000) return false;
+                    load.index = op & 0xF;
+                    load.shift = (op >> 7) & 0x1F;
+                }
+                else
+                {
+                    load.offset = (op & BIT(23)) ? (op & 0xFFF) : -(op & 0xFFF);
+                }
+                writes[rd]++;
+                loads[count++] = load;
+            }
+            else
+            {
+                return false;
+            }
+
+            // Resolve loads relative to the program counter, which can't be used as an offset
+            if (load.base == 15)
+            {
+                loads[count - 1].base = -1;
+                loads[count - 1].offset += address + 8;
+            }
+            if (load.index == 15) return false;
+        }
+    }
+
+    // Loops that set registers without reading memory can't come back to the same state, like countdowns
+    if (!count)
+    {
+        for (int i = 0; i < 16; i++)
+            if (writes[i]) return false;
+    }
+
+    // Make sure the registers used for addresses are set at most once
+    for (int i = 0; i < count; i++)
+    {
+        if ((loads[i].base >= 0 && writes[loads[i].base] > 1) || (loads[i].index >= 0 && writes[loads[i].index] > 1))
+            return false;
+    }
+
+    // Save the loads so their memory can be watched
+    if (save)
+    {
+        for (int i = 0; i < count; i++)
+            idleLoads[i] = loads[i];
+        idleLoadCount = count;
+    }
+    return true;
+}
+
+bool Interpreter::watchIdleLoop()
+{
+    // Watch the memory read by each load in an idle loop, based on the registers at the start of an iteration
+    core->memory.clearIdleWatch(arm7);
+    for (int i = 0; i < idleLoadCount; i++)
+    {
+        IdleLoad &load = idleLoads[i];
+        uint32_t address = load.offset;
+        if (load.base >= 0) address += idleRegs[load.base];
+        if (load.index >= 0) address += idleRegs[load.index] << load.shift;
+        if (!core->memory.watchIdle(arm7, address)) return false;
+    }
+    return true;
+}
+
+void Interpreter::endIdle()
+{
+    // Resume a CPU that was skipping an idle loop, counting the cycles it skipped
+    // Its cycles are brought up to the present, so it doesn't run the skipped time again after the wake-up
+    halted &= ~BIT(2);
+    PROFILE_IDLE(core, arm7, core->globalCycles - std::min(core->globalCycles, cycles));
+    cycles = std::max(cycles, core->globalCycles);
+}
+
 void Interpreter::flushPipeline()
 {
+    // Stop running from the block cache, since the next instruction may not be sequential
+    // Jumps are counted so idle loop checks can tell if anything else ran between iterations
+    blockOp = nullptr;
+    jumps++;
+
     // Adjust the program counter and refill the pipeline after a jump
     if (cpsr & BIT(5)) // THUMB mode
     {
@@ -379,6 +787,10 @@ void Interpreter::setCpsr(uint32_t value, bool save)
     if ((value & 0x1F) != (cpsr & 0x1F))
         swapRegisters(value);
 
+    // Stop running from the block cache if the instruction set changed without a jump
+    if ((value ^ cpsr) & BIT(5))
+        blockOp = nullptr;
+
     // Set the CPSR, saving the old value if requested
     if (save && spsr) *spsr = cpsr;
     cpsr = value;
@@ -25,22 +25,27 @@
 #include "defines.h"
 #include "memfile.h"
 
+#define CACHE_BLOCKS 0x1000
+#define BLOCK_OPCODES 16
+#define IDLE_LOOP_SIZE 0x20
+
 class Core;
 class Bios;
 
 class Interpreter
 {
+    friend class Jit;
+
     public:
         Bios *bios = nullptr;
         uint32_t entryAddr = 0;
 
         Interpreter(Core *core, bool arm7);
         void saveState(MemFile &file);
-        void loadState(MemFile &file);
+        void loadState(MemFile &file, bool oldCycles = false);
 
         void init();
         void directBoot();
-        void resetCycles();
 
         static void runNdsFrame(Core &core);
         static void runDsiFrame(Core &core);
@@ -48,6 +53,8 @@ class Interpreter
 
         void halt(int bit) { halted |= BIT(bit); }
         void unhalt(int bit) { halted &= ~BIT(bit); }
+        void wakeIdle() { idleChanged = true; if (halted & BIT(2)) endIdle(); }
+        void resetIdle() { idleLoop = 0; idleSafe = false; }
         void sendInterrupt(int bit);
         void interrupt();
 
@@ -65,7 +72,36 @@ class Interpreter
         void writeIrf(uint32_t mask, uint32_t value);
         void writePostFlg(uint8_t value);
 
+        void invalidateBlocks(uint8_t *start, uint8_t *end);
+        void flushBlocks(uint32_t start, uint32_t end);
+
     private:
+        struct CachedOpcode
+        {
+            uint32_t opcode;
+            union
+            {
+                int (Interpreter::*arm)(uint32_t);
+                int (Interpreter::*thumb)(uint16_t);
+            };
+        };
+
+        struct CachedBlock
+        {
+            uint32_t address;
+            uint8_t *data;
+            uint16_t size;
+            uint8_t count;
+        };
+
+        struct IdleLoad
+        {
+            int8_t base;
+            int8_t index;
+            uint8_t shift;
+            uint32_t offset;
+        };
+
         Core *core;
         bool arm7;
 
@@ -81,7 +117,7 @@ class Interpreter
         uint32_t cpsr = 0, *spsr = nullptr;
         uint32_t spsrFiq = 0, spsrSvc = 0, spsrAbt = 0, spsrIrq = 0, spsrUnd = 0;
 
-        uint32_t cycles = 0;
+        uint64_t cycles = 0;
         uint8_t halted = 0;
         bool dsiCycle = false;
 
@@ -95,7 +131,29 @@ class Interpreter
         static const uint8_t condition[0x100];
         static const uint8_t bitCount[0x100];
 
+        CachedBlock blocks[CACHE_BLOCKS] = {};
+        CachedOpcode blockOpcodes[CACHE_BLOCKS][BLOCK_OPCODES] = {};
+        CachedOpcode *blockOp = nullptr;
+        CachedOpcode *blockEnd = nullptr;
+
+        uint32_t jumps = 0;
+        uint32_t idleLoop = 0;
+        uint32_t idleJumps = 0;
+        uint32_t idleRegs[16] = {};
+        uint32_t idleCpsr = 0;
+        IdleLoad idleLoads[IDLE_LOOP_SIZE / 2] = {};
+        uint8_t idleLoadCount = 0;
+        bool idleSafe = false;
+        bool idleChanged = false;
+
         int runOpcode();
+        CachedOpcode *findBlock();
+        static bool isJump(uint32_t opcode, bool thumb);
+        bool buildBlock(CachedBlock &block, uint32_t address, bool thumb);
+        int checkIdle(int32_t offset);
+        bool decodeIdleLoop(uint32_t start, uint32_t end, bool thumb, bool save = true);
+        bool watchIdleLoop();
+        void endIdle();
         int exception(uint8_t vector);
         void flushPipeline();
         void swapRegisters(uint32_t value);
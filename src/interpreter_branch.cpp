@@ -48,7 +48,7 @@ int Interpreter::b(uint32_t opcode) // B label
     int32_t op0 = (int32_t)(opcode << 8) >> 6;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::bl(uint32_t opcode) // BL label
@@ -109,7 +109,7 @@ int Interpreter::beqT(uint16_t opcode) // BEQ label
     if (~cpsr & BIT(30)) return 1;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::bneT(uint16_t opcode) // BNE label
@@ -119,7 +119,7 @@ int Interpreter::bneT(uint16_t opcode) // BNE label
     if (cpsr & BIT(30)) return 1;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::bcsT(uint16_t opcode) // BCS label
@@ -129,7 +129,7 @@ int Interpreter::bcsT(uint16_t opcode) // BCS label
     if (~cpsr & BIT(29)) return 1;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::bccT(uint16_t opcode) // BCC label
@@ -139,7 +139,7 @@ int Interpreter::bccT(uint16_t opcode) // BCC label
     if (cpsr & BIT(29)) return 1;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::bmiT(uint16_t opcode) // BMI label
@@ -149,7 +149,7 @@ int Interpreter::bmiT(uint16_t opcode) // BMI label
     if (~cpsr & BIT(31)) return 1;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::bplT(uint16_t opcode) // BPL label
@@ -159,7 +159,7 @@ int Interpreter::bplT(uint16_t opcode) // BPL label
     if (cpsr & BIT(31)) return 1;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::bvsT(uint16_t opcode) // BVS label
@@ -169,7 +169,7 @@ int Interpreter::bvsT(uint16_t opcode) // BVS label
     if (~cpsr & BIT(28)) return 1;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::bvcT(uint16_t opcode) // BVC label
@@ -179,7 +179,7 @@ int Interpreter::bvcT(uint16_t opcode) // BVC label
     if (cpsr & BIT(28)) return 1;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::bhiT(uint16_t opcode) // BHI label
@@ -189,7 +189,7 @@ int Interpreter::bhiT(uint16_t opcode) // BHI label
     if ((cpsr & 0x60000000) != 0x20000000) return 1;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::blsT(uint16_t opcode) // BLS label
@@ -199,7 +199,7 @@ int Interpreter::blsT(uint16_t opcode) // BLS label
     if ((cpsr & 0x60000000) == 0x20000000) return 1;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::bgeT(uint16_t opcode) // BGE label
@@ -209,7 +209,7 @@ int Interpreter::bgeT(uint16_t opcode) // BGE label
     if ((cpsr ^ (cpsr << 3)) & BIT(31)) return 1;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::bltT(uint16_t opcode) // BLT label
@@ -219,7 +219,7 @@ int Interpreter::bltT(uint16_t opcode) // BLT label
     if (~(cpsr ^ (cpsr << 3)) & BIT(31)) return 1;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::bgtT(uint16_t opcode) // BGT label
@@ -229,7 +229,7 @@ int Interpreter::bgtT(uint16_t opcode) // BGT label
     if (((cpsr ^ (cpsr << 3)) | (cpsr << 1)) & BIT(31)) return 1;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::bleT(uint16_t opcode) // BLE label
@@ -239,7 +239,7 @@ int Interpreter::bleT(uint16_t opcode) // BLE label
     if (~((cpsr ^ (cpsr << 3)) | (cpsr << 1)) & BIT(31)) return 1;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::bT(uint16_t opcode) // B label
@@ -248,7 +248,7 @@ int Interpreter::bT(uint16_t opcode) // B label
     int32_t op0 = (int16_t)(opcode << 5) >> 4;
     *registers[15] += op0;
     flushPipeline();
-    return 3;
+    return (op0 < 0) ? checkIdle(op0) : 3;
 }
 
 int Interpreter::blSetupT(uint16_t opcode) // BL/BLX label
@@ -58,6 +58,12 @@ void Ipc::loadState(MemFile &file)
     }
 }
 
+uint32_t Ipc::getStatePadding()
+{
+    // Get the space needed to fill both FIFOs to their 16-word capacity in states
+    return (32 - fifos[0].size() - fifos[1].size()) * sizeof(uint32_t);
+}
+
 void Ipc::writeIpcSync(bool arm7, uint16_t mask, uint16_t value)
 {
     // Write to one of the IPCSYNC registers
@@ -34,6 +34,7 @@ class Ipc
         Ipc(Core *core): core(core) {}
         void saveState(MemFile &file);
         void loadState(MemFile &file);
+        uint32_t getStatePadding();
 
         uint16_t readIpcSync(bool arm7) { return ipcSync[arm7]; }
         uint16_t readIpcFifoCnt(bool arm7) { return ipcFifoCnt[arm7]; }
@@ -0,0 +1,1051 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "jit.h"
+#include "core.h"
+#include "settings.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#ifdef FASTMEM
+#include <atomic>
+#include <signal.h>
+#include <ucontext.h>
+#endif
+
+// Host registers, numbered as they're encoded
+enum HostReg { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+// Host condition codes, numbered as they're encoded
+enum HostCond { CC_O = 0x0, CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5 };
+
+// Sources for the carry flag when storing flags
+enum CarrySource { CARRY_KEEP, CARRY_CLEAR, CARRY_SET, CARRY_HOST };
+
+// Registers used to pass the first two arguments to a function
+#ifdef _WIN32
+#define ARG0 RCX
+#define ARG1 RDX
+#else
+#define ARG0 RDI
+#define ARG1 RSI
+#endif
+
+// The maximum amount of code that can be emitted for an opcode, including its exit
+#define OPCODE_CODE_SIZE 0x200
+
+// Compiled code keeps some values in host registers while running:
+// RBX holds the ARM9 interpreter that all state is accessed relative to
+// R14 holds the cycle count the ARM9 stops at, which is the next event or the ARM7 if it's running and comes first
+// R13 holds the global cycle count at the start of the current instruction
+// R8 and R9 hold the carry and overflow results of an instruction before they're stored as flags
+
+#ifdef FASTMEM
+
+// The JIT that fastmem faults are handled for, which is limited to one at a time
+// It's atomic so the fault handler can read it safely, since the handler could run for faults anywhere
+static std::atomic<Jit*> faultJit(nullptr);
+static struct sigaction oldAction;
+
+static void faultHandler(int signal, siginfo_t *info, void *context)
+{
+    // Let the JIT handle faults from its fastmem loads, resuming wherever it says to
+    greg_t &rip = ((ucontext_t*)context)->uc_mcontext.gregs[REG_RIP];
+    uint8_t *resume = (uint8_t*)rip;
+    Jit *jit = faultJit.load();
+    if (jit && jit->handleFault((uint8_t*)info->si_addr, resume))
+    {
+        rip = greg_t(resume);
+        return;
+    }
+
+    // Pass other faults on to the previous handler, or let them crash as normal
+    if ((oldAction.sa_flags & SA_SIGINFO) && oldAction.sa_sigaction)
+        oldAction.sa_sigaction(signal, info, context);
+    else if (oldAction.sa_handler != SIG_DFL && oldAction.sa_handler != SIG_IGN)
+        oldAction.sa_handler(signal);
+    else
+        ::signal(signal, SIG_DFL);
+}
+
+#endif
+
+template <typename T> static uint64_t handlerAddress(T handler, int32_t &adjust)
+{
+    // Get the address of a non-virtual member function and the adjustment to apply to its object pointer
+    // Itanium ABI member pointers hold both of these, while MSVC ones only hold the address for simple classes
+    uint64_t words[2] = {};
+    memcpy(words, &handler, sizeof(handler));
+    adjust = (sizeof(handler) > 8) ? int32_t(words[1]) : 0;
+    return words[0];
+}
+
+Jit::~Jit()
+{
+#ifdef FASTMEM
+    // Stop handling fastmem faults
+    Jit *self = this;
+    faultJit.compare_exchange_strong(self, nullptr);
+#endif
+
+    // Free the code buffer
+    if (!buffer) return;
+#ifdef _WIN32
+    VirtualFree(buffer, 0, MEM_RELEASE);
+#else
+    munmap(buffer, JIT_BUFFER_SIZE);
+#endif
+}
+
+bool Jit::init()
+{
+    // Allocate memory for compiled code, which is only writable while compiling and executable otherwise
+#ifdef _WIN32
+    buffer = (uint8_t*)VirtualAlloc(nullptr, JIT_BUFFER_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+    buffer = (uint8_t*)mmap(nullptr, JIT_BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer == MAP_FAILED) buffer = nullptr;
+#endif
+
+    // Fall back to the interpreter for good if executable memory isn't available
+    if (!buffer || !protect(false))
+    {
+        LOG("Failed to allocate executable memory; the ARM9 JIT will be disabled\n");
+        failed = true;
+        return false;
+    }
+
+    // Get the offsets of state used by compiled code, which all lives in the core alongside the ARM9
+    Interpreter &cpu = core->interpreter[0];
+    uint8_t *base = (uint8_t*)&cpu;
+    regsOffset = int32_t((uint8_t*)cpu.registersUsr - base);
+    ptrsOffset = int32_t((uint8_t*)cpu.registers - base);
+    cpsrOffset = int32_t((uint8_t*)&cpu.cpsr - base);
+    pipelineOffset = int32_t((uint8_t*)cpu.pipeline - base);
+    cyclesOffset = int32_t((uint8_t*)&cpu.cycles - base);
+    haltedOffset = int32_t((uint8_t*)&cpu.halted - base);
+    globalOffset = int32_t((uint8_t*)&core->globalCycles - base);
+    nextOffset = int32_t((uint8_t*)&core->nextCycles - base);
+    cycles7Offset = int32_t((uint8_t*)&core->interpreter[1].cycles - base);
+    halted7Offset = int32_t((uint8_t*)&core->interpreter[1].halted - base);
+    invalidOffset = int32_t((uint8_t*)&invalid - base);
+    code = buffer;
+
+#ifdef FASTMEM
+    // Set up fastmem loads if enabled and the view is available, installing the fault handler the first time
+    if (Settings::fastmem && !faultJit && (fastmem = core->memory.getFastmem()))
+    {
+        static bool installed = false;
+        if (!installed)
+        {
+            struct sigaction action = {};
+            action.sa_sigaction = faultHandler;
+            action.sa_flags = SA_SIGINFO;
+            sigemptyset(&action.sa_mask);
+            installed = (sigaction(SIGSEGV, &action, &oldAction) == 0);
+        }
+        if (installed)
+            faultJit = this;
+        else
+            fastmem = nullptr;
+    }
+#endif
+    return true;
+}
+
+bool Jit::runArm9()
+{
+    // Look up the compiled block starting at the current instruction, compiling it if it's missing
+    Interpreter &cpu = core->interpreter[0];
+    bool thumb = (cpu.cpsr & BIT(5));
+    uint32_t address = *cpu.registers[15] - (thumb ? 2 : 4);
+    JitBlock &block = blocks[(address >> (thumb ? 1 : 2)) & (JIT_BLOCKS - 1)];
+    if (!block.code || block.address != (address | thumb))
+    {
+        // Skip straight to the interpreter for code that was refused for being modified too often
+        if (block.address == (address | thumb) && block.writes >= JIT_WRITE_LIMIT)
+            return false;
+        if (!compile(block, address, thumb))
+            return false;
+    }
+
+    // Only use the block if it matches the pipeline, which can hold stale opcodes after code is modified
+    if (block.pipeline[0] != cpu.pipeline[0] || block.pipeline[1] != cpu.pipeline[1])
+        return false;
+
+    // Run the block, leaving the interpreter's block cache since the program counter will move
+    block.runs++;
+    cpu.blockOp = nullptr;
+    current = &block;
+    invalid = false;
+    block.code(&cpu);
+    current = nullptr;
+
+    // Patch fastmem loads that faulted to jump to their fallbacks, which can't be done while the code is executable
+    if (patches)
+    {
+        protect(true);
+        for (size_t i = 0; i < sites.size(); i++)
+        {
+            FastmemSite &site = sites[i];
+            if (!site.fault) continue;
+            int32_t offset = int32_t(site.fallback - (site.start + 5));
+            site.start[0] = 0xE9; // jmp fallback
+            memcpy(&site.start[1], &offset, sizeof(offset));
+            site.fault = false;
+        }
+        protect(false);
+        patches = false;
+    }
+    return true;
+}
+
+bool Jit::protect(bool write)
+{
+    // Switch the code buffer between writable and executable, never allowing both at once
+#ifdef _WIN32
+    DWORD old;
+    return VirtualProtect(buffer, JIT_BUFFER_SIZE, write ? PAGE_READWRITE : PAGE_EXECUTE_READ, &old);
+#else
+    return mprotect(buffer, JIT_BUFFER_SIZE, PROT_READ | (write ? PROT_WRITE : PROT_EXEC)) == 0;
+#endif
+}
+
+void Jit::invalidateBlocks(uint8_t *start, uint8_t *end)
+{
+    // Drop compiled blocks read from memory that was written to, and stop one that's running
+    if (!buffer) return;
+    for (int i = 0; i < JIT_BLOCKS; i++)
+    {
+        JitBlock &block = blocks[i];
+        if (!block.code || block.data >= end || block.data + block.size <= start)
+            continue;
+        if (&block == current) invalid = true;
+        block.code = nullptr;
+
+        // Count writes to the block's code that came before it ran much
+        if (block.runs >= JIT_WRITE_RUNS)
+            block.writes = 0;
+        else if (block.writes < JIT_WRITE_LIMIT)
+            block.writes++;
+    }
+}
+
+void Jit::flushBlocks(uint32_t start, uint32_t end)
+{
+    // Drop compiled blocks in an address range whose memory mapping changed, and stop one that's running
+    if (!buffer) return;
+    for (int i = 0; i < JIT_BLOCKS; i++)
+    {
+        JitBlock &block = blocks[i];
+        uint32_t address = block.address & ~0x1;
+        if (!block.code || address < start || address >= end)
+            continue;
+        if (&block == current) invalid = true;
+        block.code = nullptr;
+    }
+}
+
+bool Jit::compile(JitBlock &block, uint32_t address, bool thumb)
+{
+    // Reset the write count when a different block takes the slot
+    if (block.address != (address | thumb))
+        block.writes = 0;
+
+    // Get the memory to compile from, if code there can be cached
+    if (!buffer && (failed || !init())) return false;
+    uint8_t *data = core->memory.getCodePointer(false, address);
+    if (!data) return false;
+    data += address & 0xFFF;
+
+    // Read opcodes until a possible jump or the end of the memory block, plus 2 more to fill the pipeline
+    uint32_t opcodes[JIT_BLOCK_OPCODES + 2];
+    uint32_t width = thumb ? 2 : 4;
+    int count = 0, end = JIT_BLOCK_OPCODES + 2;
+    while (count < end && (address & 0xFFF) + count * width < 0x1000)
+    {
+        uint32_t opcode = 0;
+        for (uint32_t i = 0; i < width; i++)
+            opcode |= data[count * width + i] << (i * 8);
+        opcodes[count++] = opcode;
+        if (Interpreter::isJump(opcode, thumb) && end == JIT_BLOCK_OPCODES + 2)
+            end = std::min(count + 2, JIT_BLOCK_OPCODES + 2);
+    }
+
+    // Give up if there aren't enough opcodes to both run and fill the pipeline
+    if (count < 3) return false;
+    int length = count - 2;
+
+    // Start over with an empty buffer if the block might not fit
+    if (code + (length + 1) * OPCODE_CODE_SIZE > buffer + JIT_BUFFER_SIZE)
+    {
+        for (int i = 0; i < JIT_BLOCKS; i++)
+            blocks[i].code = nullptr;
+        code = buffer;
+        sites.clear();
+        patches = false;
+    }
+
+    // Make the buffer writable until the block is emitted
+    protect(true);
+
+    // Save host registers, reserving aligned stack space that also covers Windows shadow space
+    uint8_t *start = code;
+    emit8(0x53); // push rbx
+    emit8(0x41); emit8(0x55); // push r13
+    emit8(0x41); emit8(0x56); // push r14
+    emitRR(true, 0x83, 5, RSP); emit8(32); // sub rsp,32
+
+    // Load the ARM9 and the cycle counts
+    emitRR(true, 0x89, ARG0, RBX); // mov rbx,ARG0
+    emitRM(true, 0x8B, R13, RBX, globalOffset); // mov r13,[global]
+    compileLimit();
+    uint8_t *loop = code;
+
+    // Compile each instruction, stopping early when the ARM9 shouldn't continue
+    // Jumps to the sequential exit of an instruction are tracked, as are ones to the final exit
+    std::vector<uint8_t*> seqJumps[JIT_BLOCK_OPCODES];
+    std::vector<uint8_t*> exitJumps, loopJumps;
+
+    for (int i = 0; i < length; i++)
+    {
+        uint32_t opcode = opcodes[i];
+        uint32_t pc = address + (i + 2) * width;
+        uint8_t *skip = nullptr;
+
+        // Get the condition of the instruction, if it can be checked up front
+        // Conditional THUMB branches are only checked here when they loop, since otherwise the handler checks them
+        int cond = 0xE;
+        int32_t offset = 0;
+        if (thumb)
+        {
+            if ((opcode & 0xF000) == 0xD000 && ((opcode >> 8) & 0xF) < 0xE) // B<cond> label
+            {
+                cond = (opcode >> 8) & 0xF;
+                offset = int8_t(opcode) << 1;
+            }
+            else if ((opcode & 0xF800) == 0xE000) // B label
+            {
+                offset = int16_t(opcode << 5) >> 4;
+            }
+        }
+        else
+        {
+            cond = ((opcode >> 28) == 0xF) ? 0xE : (opcode >> 28);
+            if ((opcode & 0x0F000000) == 0x0A000000 && (opcode >> 28) != 0xF) // B label
+                offset = int32_t(opcode << 8) >> 6;
+        }
+
+        // Branches back to the start of the block loop within the compiled code, which is how most wait loops look
+        // Loops that could be idle are left to the branch handler instead, so it can skip them
+        bool loops = (i == length - 1 && offset && pc + offset == address);
+        if (loops && Settings::idleLoops && pc - width * 2 - address < IDLE_LOOP_SIZE)
+            loops = !core->interpreter[0].decodeIdleLoop(address, pc - width * 2, thumb, false);
+        if (thumb && cond != 0xE && !loops)
+            cond = 0xE;
+
+        // Check the condition of an instruction, skipping it for 1 cycle if false
+        if (cond < 0xE)
+        {
+            emitRM(false, 0x8B, RAX, RBX, cpsrOffset); // mov eax,[cpsr]
+            emitRR(false, 0xC1, 5, RAX); emit8(28); // shr eax,28
+            emitRex(true, 0, RCX); emit8(0xB8 | RCX); // mov rcx,imm64
+            emit64(uint64_t(&Interpreter::condition[cond << 4]));
+            emitRR(true, 0x01, RAX, RCX); // add rcx,rax
+            emitRM(false, 0x80, 7, RCX, 0); emit8(0); // cmp byte [rcx],0
+            skip = emitJump(CC_E);
+        }
+
+        if (loops)
+        {
+            // Count 3 cycles for the branch, exiting at the start of the block if the ARM9 has to stop or sync
+            emitRR(true, 0x89, R13, RAX); // mov rax,r13
+            emitRR(true, 0x83, 0, RAX); emit8(3); // add rax,3
+            emitRR(true, 0x39, R14, RAX); // cmp rax,r14
+            loopJumps.push_back(emitJump(CC_AE));
+            emitRR(true, 0x89, RAX, R13); // mov r13,rax
+            uint8_t *jump = emitJump();
+            int32_t back = int32_t(loop - code);
+            memcpy(jump, &back, sizeof(back));
+
+            // Count a single cycle if the branch wasn't taken
+            if (skip) patchJump(skip);
+            emitRR(true, 0x89, R13, RAX); // mov rax,r13
+            emitRR(true, 0x83, 0, RAX); emit8(1); // add rax,1
+        }
+        else if (thumb ? compileThumb(opcode, pc) : compileArm(opcode, pc))
+        {
+            // Count a single cycle for a natively compiled instruction, whether it was skipped or not
+            if (skip) patchJump(skip);
+            emitRR(true, 0x89, R13, RAX); // mov rax,r13
+            emitRR(true, 0x83, 0, RAX); emit8(1); // add rax,1
+        }
+        else
+        {
+            // Try a fastmem load, which jumps past the handler fallback unless it faults
+            uint8_t *entry = code, *fast = nullptr;
+            if (uint8_t *load = fastmem ? compileLoad(opcode, pc, thumb) : nullptr)
+            {
+                fast = emitJump();
+                sites.push_back({load, entry, code, false});
+            }
+
+            // Fall back to the interpreter handler, and exit without touching the pipeline if it jumped
+            compileCall(opcode, pc, thumb);
+            emitRR(true, 0x01, R13, RAX); // add rax,r13
+            emitRM(false, 0x81, 7, RBX, regsOffset + 15 * 4); emit32(pc); // cmp dword [r15],pc
+            exitJumps.push_back(emitJump(CC_NE));
+
+            // Count a single cycle if the instruction was skipped
+            if (skip)
+            {
+                uint8_t *over = emitJump();
+                patchJump(skip);
+                emitRR(true, 0x89, R13, RAX); // mov rax,r13
+                emitRR(true, 0x83, 0, RAX); emit8(1); // add rax,1
+                patchJump(over);
+            }
+
+            // Exit if the handler halted the CPU, changed the instruction set, or modified this block
+            emitRM(false, 0x80, 7, RBX, haltedOffset); emit8(0); // cmp byte [halted],0
+            seqJumps[i].push_back(emitJump(CC_NE));
+            emitRM(false, 0xF7, 0, RBX, cpsrOffset); emit32(BIT(5)); // test dword [cpsr],0x20
+            seqJumps[i].push_back(emitJump(thumb ? CC_E : CC_NE));
+            emitRM(false, 0x80, 7, RBX, invalidOffset); emit8(0); // cmp byte [invalid],0
+            seqJumps[i].push_back(emitJump(CC_NE));
+
+            // Update the cycle limit, since the handler could have scheduled events or changed the ARM7
+            compileLimit();
+
+            // Count a single cycle for a fastmem load, like the handler would
+            if (fast)
+            {
+                uint8_t *over = emitJump();
+                patchJump(fast);
+                emitRR(true, 0x89, R13, RAX); // mov rax,r13
+                emitRR(true, 0x83, 0, RAX); emit8(1); // add rax,1
+                patchJump(over);
+            }
+        }
+
+        // Exit if the ARM9 has run up to the cycle limit, or move to the next instruction
+        emitRR(true, 0x39, R14, RAX); // cmp rax,r14
+        seqJumps[i].push_back(emitJump(CC_AE));
+        emitRR(true, 0x89, RAX, R13); // mov r13,rax
+    }
+
+    // Write exits for each instruction that set the program counter and pipeline as if it ran sequentially
+    // The last instruction's exit comes first, so the end of the block falls through to it
+    for (int i = length - 1; i >= 0; i--)
+    {
+        for (size_t j = 0; j < seqJumps[i].size(); j++)
+            patchJump(seqJumps[i][j]);
+        emitRM(false, 0xC7, 0, RBX, regsOffset + 15 * 4); emit32(address + (i + 2) * width); // mov dword [r15],pc
+        emitRM(false, 0xC7, 0, RBX, pipelineOffset + 0); emit32(opcodes[i + 1]); // mov dword [pipeline0],op
+        emitRM(false, 0xC7, 0, RBX, pipelineOffset + 4); emit32(opcodes[i + 2]); // mov dword [pipeline1],op
+        if (i > 0) exitJumps.push_back(emitJump());
+    }
+
+    // Write an exit for looping that sets the program counter and pipeline to the start of the block
+    if (!loopJumps.empty())
+    {
+        exitJumps.push_back(emitJump());
+        for (size_t j = 0; j < loopJumps.size(); j++)
+            patchJump(loopJumps[j]);
+        emitRM(false, 0xC7, 0, RBX, regsOffset + 15 * 4); emit32(address + width); // mov dword [r15],pc
+        emitRM(false, 0xC7, 0, RBX, pipelineOffset + 0); emit32(opcodes[0]); // mov dword [pipeline0],op
+        emitRM(false, 0xC7, 0, RBX, pipelineOffset + 4); emit32(opcodes[1]); // mov dword [pipeline1],op
+    }
+
+    // Store the cycle counts, leaving the global one at the start of the last instruction like the interpreter
+    for (size_t j = 0; j < exitJumps.size(); j++)
+        patchJump(exitJumps[j]);
+    emitRM(true, 0x89, RAX, RBX, cyclesOffset); // mov [cycles],rax
+    emitRM(true, 0x89, R13, RBX, globalOffset); // mov [global],r13
+
+    // Restore host registers and return
+    emitRR(true, 0x83, 0, RSP); emit8(32); // add rsp,32
+    emit8(0x41); emit8(0x5E); // pop r14
+    emit8(0x41); emit8(0x5D); // pop r13
+    emit8(0x5B); // pop rbx
+    emit8(0xC3); // ret
+    protect(false);
+
+    // Track the compiled memory so writes to it drop the block
+    block.address = address | thumb;
+    block.data = data;
+    block.size = count * width;
+    block.pipeline[0] = opcodes[0];
+    block.pipeline[1] = opcodes[1];
+    block.runs = 0;
+    block.code = (void(*)(void*))start;
+    core->memory.markCode(data, block.size, true);
+    return true;
+}
+
+void Jit::compileLimit()
+{
+    // Set the cycle limit to the next event, or to the ARM7 if it's running and comes first, like the interpreter
+    emitRM(true, 0x8B, R14, RBX, nextOffset); // mov r14,[next]
+    emitRM(false, 0x80, 7, RBX, halted7Offset); emit8(0); // cmp byte [halted7],0
+    uint8_t *halted = emitJump(CC_NE);
+    emitRM(true, 0x8B, RDX, RBX, cycles7Offset); // mov rdx,[cycles7]
+    emitRR(true, 0x39, RDX, R14); // cmp r14,rdx
+    emitRR(true, 0x0F47, R14, RDX); // cmova r14,rdx
+    patchJump(halted);
+}
+
+void Jit::compileCall(uint32_t opcode, uint32_t pc, bool thumb)
+{
+    // Update the program counter and global cycles for the handler
+    emitRM(false, 0xC7, 0, RBX, regsOffset + 15 * 4); emit32(pc); // mov dword [r15],pc
+    emitRM(true, 0x89, R13, RBX, globalOffset); // mov [global],r13
+
+    // Look up the handler the interpreter would use
+    int32_t adjust;
+    uint64_t address;
+    if (thumb)
+        address = handlerAddress(Interpreter::thumbInstrs[(opcode >> 6) & 0x3FF], adjust);
+    else if ((opcode >> 28) == 0xF) // Reserved condition
+        address = handlerAddress(&Interpreter::handleReserved, adjust);
+    else
+        address = handlerAddress(Interpreter::armInstrs[((opcode >> 16) & 0xFF0) | ((opcode >> 4) & 0xF)], adjust);
+
+    // Call the handler, zero-extending the cycles it returns
+    emitRR(true, 0x89, RBX, ARG0); // mov ARG0,rbx
+    if (adjust) { emitRR(true, 0x81, 0, ARG0); emit32(adjust); } // add ARG0,adjust
+    emitMovImm(ARG1, opcode);
+    emitRex(true, 0, RAX); emit8(0xB8 | RAX); emit64(address); // mov rax,imm64
+    emitRR(false, 0xFF, 2, RAX); // call rax
+    emitRR(false, 0x89, RAX, RAX); // mov eax,eax
+}
+
+uint8_t *Jit::compileLoad(uint32_t opcode, uint32_t pc, bool thumb)
+{
+    // Decode loads with an immediate or register offset and no writeback, which don't sign-extend or load the PC
+    int size = 0, rd = 0, rn = -1, ro = -1;
+    int32_t offset = 0;
+    if (thumb)
+    {
+        switch (opcode >> 11)
+        {
+            case 0x09: size = 4, rd = (opcode >> 8) & 0x7, offset = (pc & ~0x3) + ((opcode & 0xFF) << 2); break; // LDR Rd,[PC,#i]
+            case 0x0D: size = 4, rd = opcode & 0x7, rn = (opcode >> 3) & 0x7, offset = (opcode >> 4) & 0x7C; break; // LDR Rd,[Rb,#i]
+            case 0x0F: size = 1, rd = opcode & 0x7, rn = (opcode >> 3) & 0x7, offset = (opcode >> 6) & 0x1F; break; // LDRB Rd,[Rb,#i]
+            case 0x11: size = 2, rd = opcode & 0x7, rn = (opcode >> 3) & 0x7, offset = (opcode >> 5) & 0x3E; break; // LDRH Rd,[Rb,#i]
+            case 0x13: size = 4, rd = (opcode >> 8) & 0x7, rn = 13, offset = (opcode & 0xFF) << 2; break; // LDR Rd,[SP,#i]
+
+            case 0x0B: // LDR/LDRH/LDRB Rd,[Rb,Ro]
+                if (((opcode >> 9) & 0x3) == 0x3) return nullptr;
+                size = 4 >> ((opcode >> 9) & 0x3);
+                rd = opcode & 0x7, rn = (opcode >> 3) & 0x7, ro = (opcode >> 6) & 0x7;
+                break;
+
+            default:
+                return nullptr;
+        }
+    }
+    else
+    {
+        if ((opcode >> 28) == 0xF || ((opcode >> 12) & 0xF) == 0xF)
+            return nullptr;
+        if ((opcode & 0x0F300000) == 0x05100000) // LDR/LDRB Rd,[Rn,#i]
+        {
+            size = (opcode & BIT(22)) ? 1 : 4;
+            offset = opcode & 0xFFF;
+        }
+        else if ((opcode & 0x0F7000F0) == 0x015000B0) // LDRH Rd,[Rn,#i]
+        {
+            size = 2;
+            offset = ((opcode >> 4) & 0xF0) | (opcode & 0xF);
+        }
+        else
+        {
+            return nullptr;
+        }
+        if (!(opcode & BIT(23))) offset = -offset;
+        rd = (opcode >> 12) & 0xF, rn = (opcode >> 16) & 0xF;
+    }
+
+    // Calculate the address in ECX, keeping a copy in EDX to rotate misaligned words by
+    if (rn < 0)
+    {
+        emitMovImm(RCX, offset);
+    }
+    else
+    {
+        loadReg(RCX, rn, pc);
+        if (ro >= 0)
+        {
+            loadReg(RDX, ro, pc);
+            emitRR(false, 0x01, RDX, RCX); // add ecx,edx
+        }
+        else if (offset)
+        {
+            emitRR(false, 0x81, 0, RCX); emit32(offset); // add ecx,offset
+        }
+    }
+    if (size == 4) emitRR(false, 0x89, RCX, RDX); // mov edx,ecx
+    if (size > 1) { emitRR(false, 0x83, 4, RCX); emit8(-size); } // and ecx,-size
+
+    // Load from the fastmem view, which is the instruction that can fault
+    emitRex(true, 0, RAX); emit8(0xB8 | RAX); emit64(uint64_t(fastmem)); // mov rax,imm64
+    uint8_t *load = code;
+    if (size == 4) { emit8(0x8B); emit8(0x04); emit8(0x08); } // mov eax,[rax+rcx]
+    else if (size == 2) { emit8(0x0F); emit8(0xB7); emit8(0x04); emit8(0x08); } // movzx eax,word [rax+rcx]
+    else { emit8(0x0F); emit8(0xB6); emit8(0x04); emit8(0x08); } // movzx eax,byte [rax+rcx]
+
+    // Rotate misaligned words and store the result
+    if (size == 4)
+    {
+        emitRR(false, 0x89, RDX, RCX); // mov ecx,edx
+        emitRR(false, 0xC1, 4, RCX); emit8(3); // shl ecx,3
+        emitRR(false, 0xD3, 1, RAX); // ror eax,cl
+    }
+    storeReg(rd, RAX);
+    return load;
+}
+
+bool Jit::handleFault(uint8_t *host, uint8_t *&rip)
+{
+    // Only handle faults from fastmem loads in compiled code, which hit memory that isn't in the fastmem view
+    // This runs in a signal handler, so it only looks up the load and can't make any calls that aren't safe there
+    if (!fastmem || rip < buffer || rip >= buffer + JIT_BUFFER_SIZE || host < fastmem || host >= fastmem + 0x100000000)
+        return false;
+
+    // Send the load to its handler fallback, and mark it to jump there directly once the block returns
+    // Sites are added as code is emitted, so they can be binary searched by address
+    auto site = std::lower_bound(sites.begin(), sites.end(), rip,
+        [](const FastmemSite &site, uint8_t *rip) { return site.load < rip; });
+    if (site == sites.end() || site->load != rip)
+        return false;
+    site->fault = true;
+    patches = true;
+    rip = site->fallback;
+    return true;
+}
+
+bool Jit::compileArm(uint32_t opcode, uint32_t pc)
+{
+    // Only compile data processing instructions, excluding ones with register shift amounts
+    // Instructions with carry input or that write the program counter are left to the interpreter
+    int op = (opcode >> 21) & 0xF;
+    int rd = (opcode >> 12) & 0xF;
+    bool test = (op >= 0x8 && op <= 0xB);
+    bool flags = (opcode & BIT(20));
+    bool imm = (opcode & BIT(25));
+    if ((opcode >> 28) == 0xF || (opcode & 0x0C000000) || (!imm && (opcode & BIT(4))) || (test && !flags))
+        return false;
+    if ((op >= 0x5 && op <= 0x7) || (!test && rd == 0xF))
+        return false;
+
+    // Rotate right with extend uses the carry flag, so leave it to the interpreter too
+    int type = (opcode >> 5) & 0x3;
+    int amount = (opcode >> 7) & 0x1F;
+    if (!imm && type == 3 && amount == 0)
+        return false;
+
+    // Get the second operand, with the shifter's carry output for flag-setting logical operations
+    bool logical = !((op >= 0x2 && op <= 0x4) || op == 0xA || op == 0xB);
+    bool shiftCarry = (flags && logical);
+    int carry = CARRY_KEEP;
+    if (imm) // Rotated immediate
+    {
+        uint32_t value = opcode & 0xFF;
+        uint8_t shift = (opcode >> 7) & 0x1E;
+        if (shift) value = (value << (32 - shift)) | (value >> shift);
+        emitMovImm(RCX, value);
+        if (shift) carry = (value & BIT(31)) ? CARRY_SET : CARRY_CLEAR;
+    }
+    else if (amount) // Register shifted by immediate
+    {
+        static const uint8_t shifts[] = { 4, 5, 7, 1 }; // SHL, SHR, SAR, ROR
+        loadReg(RCX, opcode & 0xF, pc);
+        emitRR(false, 0xC1, shifts[type], RCX); emit8(amount);
+        if (shiftCarry) { emitRR(false, 0x0F92, 0, R8); carry = CARRY_HOST; } // setc r8b
+    }
+    else // Register shifted by 0, which translates to 32 for right shifts
+    {
+        loadReg(RCX, opcode & 0xF, pc);
+        if (type != 0 && shiftCarry)
+        {
+            emitRR(false, 0x0FBA, 4, RCX); emit8(31); // bt ecx,31
+            emitRR(false, 0x0F92, 0, R8); // setc r8b
+            carry = CARRY_HOST;
+        }
+        if (type == 1) emitMovImm(RCX, 0);
+        else if (type == 2) { emitRR(false, 0xC1, 7, RCX); emit8(31); } // sar ecx,31
+    }
+
+    // Get the first operand and perform the operation
+    if (op != 0xD && op != 0xF)
+        loadReg(RAX, (opcode >> 16) & 0xF, pc);
+    switch (op)
+    {
+        case 0x0: case 0x8: emitRR(false, 0x21, RCX, RAX); break; // AND/TST: and eax,ecx
+        case 0x1: case 0x9: emitRR(false, 0x31, RCX, RAX); break; // EOR/TEQ: xor eax,ecx
+        case 0x2: case 0xA: emitRR(false, 0x29, RCX, RAX); break; // SUB/CMP: sub eax,ecx
+        case 0x4: case 0xB: emitRR(false, 0x01, RCX, RAX); break; // ADD/CMN: add eax,ecx
+        case 0xC: emitRR(false, 0x09, RCX, RAX); break; // ORR: or eax,ecx
+        case 0xD: emitRR(false, 0x89, RCX, RAX); break; // MOV: mov eax,ecx
+
+        case 0x3: // RSB: sub ecx,eax; mov eax,ecx
+            emitRR(false, 0x29, RAX, RCX);
+            emitRR(false, 0x89, RCX, RAX);
+            break;
+
+        case 0xE: // BIC: not ecx; and eax,ecx
+            emitRR(false, 0xF7, 2, RCX);
+            emitRR(false, 0x21, RCX, RAX);
+            break;
+
+        case 0xF: // MVN: mov eax,ecx; not eax
+            emitRR(false, 0x89, RCX, RAX);
+            emitRR(false, 0xF7, 2, RAX);
+            break;
+    }
+
+    // Capture the carry and overflow of arithmetic operations; ARM's carry is inverted from x86's for subtraction
+    if (flags && !logical)
+    {
+        emitRR(false, 0x0F90 | ((op == 0x4 || op == 0xB) ? CC_B : CC_AE), 0, R8); // setc/setnc r8b
+        emitRR(false, 0x0F90 | CC_O, 0, R9); // seto r9b
+        carry = CARRY_HOST;
+    }
+
+    // Store the result and flags
+    if (!test) storeReg(rd, RAX);
+    if (flags) storeFlags(!logical, carry);
+    return true;
+}
+
+bool Jit::compileThumb(uint16_t opcode, uint32_t pc)
+{
+    // Only compile ALU instructions, leaving ones with carry input or register shift amounts to the interpreter
+    switch (opcode >> 11)
+    {
+        case 0x00: case 0x01: case 0x02: // LSL/LSR/ASR Rd,Rs,#i
+        {
+            // Right shifts of 0 translate to 32, which are rare enough to leave to the interpreter
+            static const uint8_t shifts[] = { 4, 5, 7 }; // SHL, SHR, SAR
+            int amount = (opcode >> 6) & 0x1F;
+            if (!amount && (opcode >> 11))
+                return false;
+            loadReg(RAX, (opcode >> 3) & 0x7, pc);
+            if (amount)
+            {
+                emitRR(false, 0xC1, shifts[opcode >> 11], RAX); emit8(amount);
+                emitRR(false, 0x0F92, 0, R8); // setc r8b
+            }
+            storeReg(opcode & 0x7, RAX);
+            storeFlags(false, amount ? CARRY_HOST : CARRY_KEEP);
+            return true;
+        }
+
+        case 0x03: // ADD/SUB Rd,Rs,Rn/#i
+        {
+            bool sub = (opcode & BIT(9));
+            loadReg(RAX, (opcode >> 3) & 0x7, pc);
+            if (opcode & BIT(10))
+                emitMovImm(RCX, (opcode >> 6) & 0x7);
+            else
+                loadReg(RCX, (opcode >> 6) & 0x7, pc);
+            emitRR(false, sub ? 0x29 : 0x01, RCX, RAX); // sub/add eax,ecx
+            emitRR(false, 0x0F90 | (sub ? CC_AE : CC_B), 0, R8); // setnc/setc r8b
+            emitRR(false, 0x0F90 | CC_O, 0, R9); // seto r9b
+            storeReg(opcode & 0x7, RAX);
+            storeFlags(true, CARRY_HOST);
+            return true;
+        }
+
+        case 0x04: // MOV Rd,#i
+            emitMovImm(RAX, opcode & 0xFF);
+            storeReg((opcode >> 8) & 0x7, RAX);
+            storeFlags(false, CARRY_KEEP);
+            return true;
+
+        case 0x05: case 0x06: case 0x07: // CMP/ADD/SUB Rd,#i
+        {
+            bool add = ((opcode >> 11) == 0x06);
+            loadReg(RAX, (opcode >> 8) & 0x7, pc);
+            emitRR(false, 0x81, add ? 0 : 5, RAX); emit32(opcode & 0xFF); // add/sub eax,imm
+            emitRR(false, 0x0F90 | (add ? CC_B : CC_AE), 0, R8); // setc/setnc r8b
+            emitRR(false, 0x0F90 | CC_O, 0, R9); // seto r9b
+            if ((opcode >> 11) != 0x05) storeReg((opcode >> 8) & 0x7, RAX);
+            storeFlags(true, CARRY_HOST);
+            return true;
+        }
+
+        case 0x08: // ALU operations and high register operations
+        {
+            if (opcode & BIT(10)) // ADD/CMP/MOV Rd,Rs
+            {
+                int op = (opcode >> 8) & 0x3;
+                int rd = ((opcode >> 4) & 0x8) | (opcode & 0x7);
+                if (op == 0x3 || (op != 0x1 && rd == 0xF))
+                    return false;
+                loadReg(RCX, (opcode >> 3) & 0xF, pc);
+                if (op == 0x2)
+                {
+                    storeReg(rd, RCX);
+                    return true;
+                }
+                loadReg(RAX, rd, pc);
+                emitRR(false, (op == 0x0) ? 0x01 : 0x29, RCX, RAX); // add/sub eax,ecx
+                if (op == 0x0)
+                {
+                    storeReg(rd, RAX);
+                    return true;
+                }
+                emitRR(false, 0x0F90 | CC_AE, 0, R8); // setnc r8b
+                emitRR(false, 0x0F90 | CC_O, 0, R9); // seto r9b
+                storeFlags(true, CARRY_HOST);
+                return true;
+            }
+
+            // Only compile AND, EOR, TST, CMP, CMN, ORR, BIC, and MVN
+            int op = (opcode >> 6) & 0xF;
+            if (!((0xDD03 >> op) & 0x1))
+                return false;
+            loadReg(RAX, opcode & 0x7, pc);
+            loadReg(RCX, (opcode >> 3) & 0x7, pc);
+            switch (op)
+            {
+                case 0x0: case 0x8: emitRR(false, 0x21, RCX, RAX); break; // AND/TST: and eax,ecx
+                case 0x1: emitRR(false, 0x31, RCX, RAX); break; // EOR: xor eax,ecx
+                case 0xA: emitRR(false, 0x29, RCX, RAX); break; // CMP: sub eax,ecx
+                case 0xB: emitRR(false, 0x01, RCX, RAX); break; // CMN: add eax,ecx
+                case 0xC: emitRR(false, 0x09, RCX, RAX); break; // ORR: or eax,ecx
+
+                case 0xE: // BIC: not ecx; and eax,ecx
+                    emitRR(false, 0xF7, 2, RCX);
+                    emitRR(false, 0x21, RCX, RAX);
+                    break;
+
+                case 0xF: // MVN: mov eax,ecx; not eax
+                    emitRR(false, 0x89, RCX, RAX);
+                    emitRR(false, 0xF7, 2, RAX);
+                    break;
+            }
+
+            // Store the result and flags, with carry and overflow for arithmetic
+            if (op == 0xA || op == 0xB)
+            {
+                emitRR(false, 0x0F90 | ((op == 0xB) ? CC_B : CC_AE), 0, R8); // setc/setnc r8b
+                emitRR(false, 0x0F90 | CC_O, 0, R9); // seto r9b
+                storeFlags(true, CARRY_HOST);
+                return true;
+            }
+            if (op != 0x8) storeReg(opcode & 0x7, RAX);
+            storeFlags(false, CARRY_KEEP);
+            return true;
+        }
+
+        case 0x14: // ADD Rd,PC,#i
+            emitMovImm(RAX, (pc & ~0x3) + ((opcode & 0xFF) << 2));
+            storeReg((opcode >> 8) & 0x7, RAX);
+            return true;
+
+        case 0x15: // ADD Rd,SP,#i
+            loadReg(RAX, 13, pc);
+            emitRR(false, 0x81, 0, RAX); emit32((opcode & 0xFF) << 2); // add eax,imm
+            storeReg((opcode >> 8) & 0x7, RAX);
+            return true;
+
+        case 0x16: // ADD SP,#i
+            if ((opcode & 0xFF00) != 0xB000)
+                return false;
+            loadReg(RAX, 13, pc);
+            emitRR(false, 0x81, 0, RAX); // add eax,imm
+            emit32(((opcode & BIT(7)) ? (0 - (opcode & 0x7F)) : (opcode & 0x7F)) << 2);
+            storeReg(13, RAX);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+void Jit::loadReg(int reg, int arm, uint32_t pc)
+{
+    // Load an ARM register into a host register, using the constant value of the program counter
+    // Registers below 8 are never banked, so they can be accessed directly instead of through pointers
+    if (arm == 15)
+    {
+        emitMovImm(reg, pc);
+    }
+    else if (arm < 8)
+    {
+        emitRM(false, 0x8B, reg, RBX, regsOffset + arm * 4); // mov reg,[rN]
+    }
+    else
+    {
+        emitRM(true, 0x8B, R11, RBX, ptrsOffset + arm * 8); // mov r11,[registers+N]
+        emitRM(false, 0x8B, reg, R11, 0); // mov reg,[r11]
+    }
+}
+
+void Jit::storeReg(int arm, int reg)
+{
+    // Store a host register to an ARM register, which is never the program counter
+    if (arm < 8)
+    {
+        emitRM(false, 0x89, reg, RBX, regsOffset + arm * 4); // mov [rN],reg
+    }
+    else
+    {
+        emitRM(true, 0x8B, R11, RBX, ptrsOffset + arm * 8); // mov r11,[registers+N]
+        emitRM(false, 0x89, reg, R11, 0); // mov [r11],reg
+    }
+}
+
+void Jit::storeFlags(bool overflow, int carry)
+{
+    // Clear the flags that will be set
+    uint32_t mask = 0xC0000000 | ((carry != CARRY_KEEP) ? BIT(29) : 0) | (overflow ? BIT(28) : 0);
+    emitRM(false, 0x8B, RDX, RBX, cpsrOffset); // mov edx,[cpsr]
+    emitRR(false, 0x81, 4, RDX); emit32(~mask); // and edx,~mask
+
+    // Set the sign and zero flags based on the result in EAX
+    emitRR(false, 0x89, RAX, R10); // mov r10d,eax
+    emitRR(false, 0x81, 4, R10); emit32(BIT(31)); // and r10d,BIT(31)
+    emitRR(false, 0x09, R10, RDX); // or edx,r10d
+    emitRR(false, 0x85, RAX, RAX); // test eax,eax
+    emitRR(false, 0x0F90 | CC_E, 0, R10); // setz r10b
+    emitRR(false, 0x0FB6, R10, R10); // movzx r10d,r10b
+    emitRR(false, 0xC1, 4, R10); emit8(30); // shl r10d,30
+    emitRR(false, 0x09, R10, RDX); // or edx,r10d
+
+    // Set the carry flag from a constant or R8
+    if (carry == CARRY_SET)
+    {
+        emitRR(false, 0x81, 1, RDX); emit32(BIT(29)); // or edx,BIT(29)
+    }
+    else if (carry == CARRY_HOST)
+    {
+        emitRR(false, 0x0FB6, R10, R8); // movzx r10d,r8b
+        emitRR(false, 0xC1, 4, R10); emit8(29); // shl r10d,29
+        emitRR(false, 0x09, R10, RDX); // or edx,r10d
+    }
+
+    // Set the overflow flag from R9
+    if (overflow)
+    {
+        emitRR(false, 0x0FB6, R10, R9); // movzx r10d,r9b
+        emitRR(false, 0xC1, 4, R10); emit8(28); // shl r10d,28
+        emitRR(false, 0x09, R10, RDX); // or edx,r10d
+    }
+
+    emitRM(false, 0x89, RDX, RBX, cpsrOffset); // mov [cpsr],edx
+}
+
+void Jit::emit32(uint32_t value)
+{
+    // Emit a little-endian 32-bit value
+    for (int i = 0; i < 32; i += 8)
+        emit8(value >> i);
+}
+
+void Jit::emit64(uint64_t value)
+{
+    // Emit a little-endian 64-bit value
+    for (int i = 0; i < 64; i += 8)
+        emit8(value >> i);
+}
+
+void Jit::emitRex(bool wide, int reg, int rm)
+{
+    // Emit a REX prefix if an operation is 64-bit or uses extended registers
+    uint8_t rex = 0x40 | (wide << 3) | ((reg & 0x8) >> 1) | ((rm & 0x8) >> 3);
+    if (rex != 0x40) emit8(rex);
+}
+
+void Jit::emitRR(bool wide, uint16_t op, int reg, int rm)
+{
+    // Emit an operation with a register operand, where reg can also be an opcode extension
+    emitRex(wide, reg, rm);
+    if (op > 0xFF) emit8(op >> 8);
+    emit8(op);
+    emit8(0xC0 | ((reg & 0x7) << 3) | (rm & 0x7));
+}
+
+void Jit::emitRM(bool wide, uint16_t op, int reg, int base, int32_t disp)
+{
+    // Emit an operation with a memory operand at a 32-bit displacement from a base register
+    // Bases that would need an SIB byte (RSP and R12) aren't supported
+    emitRex(wide, reg, base);
+    if (op > 0xFF) emit8(op >> 8);
+    emit8(op);
+    emit8(0x80 | ((reg & 0x7) << 3) | (base & 0x7));
+    emit32(disp);
+}
+
+void Jit::emitMovImm(int reg, uint32_t value)
+{
+    // Emit a move of a 32-bit immediate, which zero-extends to 64 bits
+    emitRex(false, 0, reg);
+    emit8(0xB8 | (reg & 0x7));
+    emit32(value);
+}
+
+uint8_t *Jit::emitJump(int cond)
+{
+    // Emit a jump with a 32-bit offset, conditional if a condition code is given, and return the offset to patch
+    if (cond < 0)
+    {
+        emit8(0xE9);
+    }
+    else
+    {
+        emit8(0x0F);
+        emit8(0x80 | cond);
+    }
+    uint8_t *offset = code;
+    emit32(0);
+    return offset;
+}
+
+void Jit::patchJump(uint8_t *jump)
+{
+    // Point a jump at the current code position
+    int32_t offset = int32_t(code - (jump + 4));
+    memcpy(jump, &offset, sizeof(offset));
+}
+
+#else
+
+// Other hosts have no JIT, so the interpreter is always used
+
+Jit::~Jit() {}
+bool Jit::runArm9() { return false; }
+void Jit::invalidateBlocks(uint8_t *start, uint8_t *end) {}
+void Jit::flushBlocks(uint32_t start, uint32_t end) {}
+bool Jit::handleFault(uint8_t *host, uint8_t *&rip) { return false; }
+
+#endif
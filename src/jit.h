@@ -0,0 +1,112 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef JIT_H
+#define JIT_H
+
+#include <cstdint>
+#include <vector>
+
+#define JIT_BLOCKS 0x1000
+#define JIT_BLOCK_OPCODES 32
+#define JIT_BUFFER_SIZE 0x1000000
+#define JIT_WRITE_LIMIT 4
+#define JIT_WRITE_RUNS 64
+
+class Core;
+
+// Recompiles ARM9 code to x86-64, falling back to interpreter handlers for anything without a native version
+// Compiled code runs directly on the interpreter state, so the two can be switched between at any instruction
+// Blocks stop at the same points as the interpreter, which is scheduled events and passing the ARM7 when it's running
+// Code that keeps being modified shortly after it's compiled is left to the interpreter, which handles it cheaper
+// Simple loads can read straight from a fastmem view, where faults on memory outside it fall back to the handler
+class Jit
+{
+    public:
+        Jit(Core *core): core(core) {}
+        ~Jit();
+
+        bool runArm9();
+        void invalidateBlocks(uint8_t *start, uint8_t *end);
+        void flushBlocks(uint32_t start, uint32_t end);
+        bool handleFault(uint8_t *host, uint8_t *&rip);
+
+    private:
+        struct JitBlock
+        {
+            uint32_t address;
+            uint8_t *data;
+            uint16_t size;
+            uint32_t pipeline[2];
+            uint32_t runs;
+            uint8_t writes;
+            void (*code)(void*);
+        };
+
+        struct FastmemSite
+        {
+            uint8_t *load;
+            uint8_t *start;
+            uint8_t *fallback;
+            bool fault;
+        };
+
+        Core *core;
+        JitBlock blocks[JIT_BLOCKS] = {};
+        JitBlock *current = nullptr;
+        bool invalid = false;
+
+        uint8_t *buffer = nullptr;
+        uint8_t *code = nullptr;
+        bool failed = false;
+
+        uint8_t *fastmem = nullptr;
+        std::vector<FastmemSite> sites;
+        bool patches = false;
+
+        int32_t regsOffset = 0, ptrsOffset = 0, cpsrOffset = 0;
+        int32_t pipelineOffset = 0, cyclesOffset = 0, haltedOffset = 0;
+        int32_t globalOffset = 0, nextOffset = 0, cycles7Offset = 0, halted7Offset = 0;
+        int32_t invalidOffset = 0;
+
+        bool init();
+        bool protect(bool write);
+        bool compile(JitBlock &block, uint32_t address, bool thumb);
+        bool compileArm(uint32_t opcode, uint32_t pc);
+        bool compileThumb(uint16_t opcode, uint32_t pc);
+        void compileCall(uint32_t opcode, uint32_t pc, bool thumb);
+        uint8_t *compileLoad(uint32_t opcode, uint32_t pc, bool thumb);
+        void compileLimit();
+
+        void loadReg(int reg, int arm, uint32_t pc);
+        void storeReg(int arm, int reg);
+        void storeFlags(bool overflow, int carry);
+
+        void emit8(uint8_t value) { *code++ = value; }
+        void emit32(uint32_t value);
+        void emit64(uint64_t value);
+        void emitRex(bool wide, int reg, int rm);
+        void emitRR(bool wide, uint16_t op, int reg, int rm);
+        void emitRM(bool wide, uint16_t op, int reg, int base, int32_t disp);
+        void emitMovImm(int reg, uint32_t value);
+        uint8_t *emitJump(int cond = -1);
+        void patchJump(uint8_t *jump);
+};
+
+#endif // JIT_H
@@ -18,10 +18,9 @@ namespace GameDB
 }
 
 #ifdef __LIBRETRO__
-void CartridgeNds::detectSaveSize()
+int CartridgeNds::lookupSaveSize()
 {
-  GameInfo info = GameDB::analyze(romCode);
-  if (info.saveSize) resizeSave(info.saveSize, false);
+  return GameDB::analyze(romCode).saveSize;
 }
 #endif
 
@@ -49,6 +49,10 @@ static int gbaSaveFd = -1;
 static std::vector<uint32_t> videoBuffer;
 static uint32_t videoBufferSize;
 
+static int runAheadFrames;
+static std::vector<uint8_t> runAheadState;
+static std::vector<uint8_t> runAheadPages;
+
 static std::string micInputMode;
 static std::string micButtonMode;
 
@@ -279,6 +283,7 @@ static void initInput(void)
     { 0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_L2, "Microphone" },
     { 0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_R2, "Swap screens" },
     { 0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_R3, "Touch joystick" },
+    { 0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_L3, "Rewind" },
     { 0, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_RIGHT, RETRO_DEVICE_ID_ANALOG_X, "Touch joystick X" },
     { 0, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_RIGHT, RETRO_DEVICE_ID_ANALOG_Y, "Touch joystick Y" },
     { 0 },
@@ -293,10 +298,18 @@ static void initConfig()
     { "noods_directBoot", "Direct Boot; enabled|disabled" },
     { "noods_fpsLimiter", "FPS Limiter; disabled|enabled" },
     { "noods_romInRam", "Keep ROM in RAM; disabled|enabled" },
+    { "noods_mmapRom", "Memory-Map ROM; enabled|disabled" },
     { "noods_dsiMode", "DSi Homebrew Mode; disabled|enabled" },
     { "noods_threaded2D", "Threaded 2D; enabled|disabled" },
     { "noods_threaded3D", "Threaded 3D; 1 Thread|2 Threads|3 Threads|4 Threads|Disabled" },
     { "noods_highRes3D", "High Resolution 3D; disabled|enabled" },
+    { "noods_arm9Jit", "ARM9 JIT; disabled|enabled" },
+    { "noods_idleLoops", "Skip Idle Loops; enabled|disabled" },
+    { "noods_fastmem", "JIT Fastmem; disabled|enabled" },
+    { "noods_runAhead", "Run-Ahead; Disabled|1 Frame|2 Frames|3 Frames|4 Frames" },
+    { "noods_rewindFrames", "Rewind Interval; Disabled|1 Frame|5 Frames|10 Frames|30 Frames" },
+    { "noods_rewindBudget", "Rewind Buffer; 64 MB|32 MB|128 MB|256 MB" },
+    { "noods_trace", "Record Performance Trace; disabled|enabled" },
     { "noods_screenArrangement", "Screen Arrangement; Automatic|Vertical|Horizontal|Single Screen" },
     { "noods_screenRotation", "Screen Rotation; Normal|Rotated Left|Rotated Right" },
     { "noods_screenSizing", "Screen Sizing; Even|Enlarge Top|Enlarge Bottom" },
@@ -317,6 +330,27 @@ static void initConfig()
   envCallback(RETRO_ENVIRONMENT_SET_VARIABLES, (void*)values);
 }
 
+static void updateTrace(bool enabled)
+{
+  if (enabled == Tracer::enabled.load())
+    return;
+
+  if (enabled)
+  {
+    Tracer::setThreadName("Emulator");
+    Tracer::setEnabled(true);
+    return;
+  }
+
+  Tracer::setEnabled(false);
+  std::string path = savesPath + getNameFromPath(ndsPath != "" ? ndsPath : gbaPath) + ".trace.json";
+
+  if (Tracer::dump(path))
+    logCallback(RETRO_LOG_INFO, "Trace written to %s", path.c_str());
+  else
+    logCallback(RETRO_LOG_WARN, "Error writing trace to %s", path.c_str());
+}
+
 static void updateConfig()
 {
   Settings::basePath = savesPath + "noods";
@@ -329,12 +363,21 @@ static void updateConfig()
   Settings::directBoot = fetchVariableBool("noods_directBoot", true);
   Settings::fpsLimiter = fetchVariableBool("noods_fpsLimiter", false);
   Settings::romInRam = fetchVariableBool("noods_romInRam", false);
+  Settings::mmapRom = fetchVariableBool("noods_mmapRom", true);
   Settings::dsiMode = fetchVariableBool("noods_dsiMode", false);
   Settings::threaded2D = fetchVariableBool("noods_threaded2D", true);
   Settings::threaded3D = fetchVariableEnum("noods_threaded3D", {"Disabled", "1 Thread", "2 Threads", "3 Threads", "4 Threads"}, 1);
   Settings::highRes3D = fetchVariableBool("noods_highRes3D", false);
+  Settings::arm9Jit = fetchVariableBool("noods_arm9Jit", false);
+  Settings::idleLoops = fetchVariableBool("noods_idleLoops", true);
+  Settings::fastmem = fetchVariableBool("noods_fastmem", false);
   Settings::screenFilter = fetchVariableEnum("noods_screenFilter", {"Nearest", "Upscaled", "Linear"});
   Settings::screenGhost = fetchVariableBool("noods_screenGhost", false);
+  Settings::rewindFrames = fetchVariableInt("noods_rewindFrames", 0);
+  Settings::rewindBudget = fetchVariableInt("noods_rewindBudget", 64);
+
+  runAheadFrames = fetchVariableEnum("noods_runAhead", {"Disabled", "1 Frame", "2 Frames", "3 Frames", "4 Frames"});
+  updateTrace(fetchVariableBool("noods_trace", false));
 
   micInputMode = fetchVariable("noods_micInputMode", "Silence");
   micButtonMode = fetchVariable("noods_micButtonMode", "Toggle");
@@ -599,6 +642,78 @@ static void renderAudio()
   audioBatchCallback(buffer, size);
 }
 
+static void runAhead()
+{
+  // Run the real frame, keeping its audio but not its video
+  core->runFrame();
+  core->gpu.dropFrame();
+
+  // Snapshot the real state into buffers that are reused between frames
+  // Memory pages are only copied if they were written since the last snapshot or restore
+  // Unwritten save changes are kept aside, since loading a state would otherwise mark the whole save
+  Cartridge::SaveDirty ndsDirty = core->cartridgeNds.getSaveDirty();
+  Cartridge::SaveDirty gbaDirty = core->cartridgeGba.getSaveDirty();
+  size_t size = core->saveStates.saveSnapshot(runAheadState);
+  bool full = runAheadPages.empty();
+  runAheadPages.resize(ARENA_PAGES << 12);
+
+  for (uint32_t i = 0; i < ARENA_PAGES; i++)
+  {
+    if (core->memory.takeDirty(DIRTY_RUNAHEAD, i) || full)
+      memcpy(&runAheadPages[i << 12], core->memory.getPage(i), 0x1000);
+  }
+
+  // Run ahead with the same input and no audio, only showing the last frame
+  core->spu.setOutput(false);
+  for (int i = 0; i < runAheadFrames; i++)
+  {
+    core->runFrame();
+    if (i < runAheadFrames - 1)
+      core->gpu.dropFrame();
+  }
+  core->spu.setOutput(true);
+  renderVideo();
+
+  // Go back to the real state, along with the save changes it had
+  // Only pages written while running ahead are copied back, and memory is only remapped if its mapping changed
+  for (uint32_t i = 0; i < ARENA_PAGES; i++)
+  {
+    if (core->memory.takeDirty(DIRTY_RUNAHEAD, i))
+      core->memory.restorePage(DIRTY_RUNAHEAD, i, &runAheadPages[i << 12]);
+  }
+
+  MemFile restore(static_cast<const void*>(runAheadState.data()), size);
+  core->saveStates.loadSections(restore, true);
+  core->cartridgeNds.setSaveDirty(ndsDirty);
+  core->cartridgeGba.setSaveDirty(gbaDirty);
+}
+
+#ifdef PROFILE
+static void logStats()
+{
+  // Log the last frame's profiling counters about once a second
+  static int frames = 0;
+  if (++frames < 60) return;
+  frames = 0;
+
+  CoreStats &stats = core->stats;
+  uint64_t events = 0, taskTime = 0;
+  for (int i = 0; i < MAX_TASKS; i++)
+  {
+    events += stats.taskCounts[i];
+    taskTime += stats.taskTimes[i];
+  }
+
+  double cycles = std::max<uint64_t>(stats.frameCycles, 1);
+  logCallback(RETRO_LOG_INFO,
+    "Stats: ARM9 %llu ops %.1f%% halted (%.1f%% idle), ARM7 %llu ops %.1f%% halted (%.1f%% idle), "
+    "%llu GX commands, %llu events in %.3fms\n",
+    (unsigned long long)stats.opcodes[0], stats.haltedCycles[0] * 100.0 / cycles, stats.idleCycles[0] * 100.0 / cycles,
+    (unsigned long long)stats.opcodes[1], stats.haltedCycles[1] * 100.0 / cycles, stats.idleCycles[1] * 100.0 / cycles,
+    (unsigned long long)stats.gxCommands, (unsigned long long)events, taskTime / 1000000.0);
+}
+#endif
+
 static void openMicrophone()
 {
   if (micAvailable && !microphone)
@@ -876,12 +991,15 @@ void retro_unload_game(void)
 {
   if (core)
   {
-    core->cartridgeNds.writeSave();
-    core->cartridgeGba.writeSave();
+    core->cartridgeNds.flushSave();
+    core->cartridgeGba.flushSave();
 
+    updateTrace(false);
     delete core;
   }
 
+  std::vector<uint8_t>().swap(runAheadState);
+  std::vector<uint8_t>().swap(runAheadPages);
   closeMicrophone();
   closeSaveFileDesc();
 }
@@ -1035,10 +1153,24 @@ void retro_run(void)
     }
   }
 
-  core->runFrame();
+  core->rewind.setRewinding(getButtonState(RETRO_DEVICE_ID_JOYPAD_L3));
+  core->rewind.update();
+
+  if (runAheadFrames > 0)
+  {
+    runAhead();
+  }
+  else
+  {
+    core->runFrame();
+    renderVideo();
+  }
 
-  renderVideo();
   renderAudio();
+
+#ifdef PROFILE
+  logStats();
+#endif
 }
 
 void retro_set_controller_port_device(unsigned port, unsigned device)
@@ -1047,8 +1179,10 @@ void retro_set_controller_port_device(unsigned port, unsigned device)
 
 size_t retro_serialize_size(void)
 {
-  // HACK: Usually around 6MB but can vary frame to frame!
-  return 1024 * 1024 * 8;
+  if (!core) return 0;
+
+  SaveState saveState(core);
+  return saveState.size();
 }
 
 bool retro_serialize(void* data, size_t size)
@@ -3,7 +3,16 @@
 #include <cstring>
 
 const char* SaveState::stateTag = "NDSR";
-const uint32_t SaveState::stateVersion = 2;
+const uint32_t SaveState::stateVersion = 4;
+const uint32_t SaveState::oldCyclesVersion = 2;
+const uint32_t SaveState::linearVersion = 3;
+
+size_t SaveState::size()
+{
+  // Get the exact size of a state, which stays the same across save detection
+  // It only changes if the frontend resizes the save past what was reserved for it
+  return 8 + core->saveStates.getSectionsSize();
+}
 
 bool SaveState::check(const void* data, size_t& size)
 {
@@ -17,11 +26,11 @@ bool SaveState::check(const void* data, size_t& size)
     if (tag[i] != stateTag[i])
       return false;
 
-  // Check if the state version matches
+  // Check if the state version matches, allowing older states that can be converted
   uint32_t version;
   memcpy(&version, (uint8_t*)data + 4, 4);
 
-  if (version != stateVersion)
+  if (version != stateVersion && version != linearVersion && version != oldCyclesVersion)
     return false;
 
   return true;
@@ -29,54 +38,36 @@ bool SaveState::check(const void* data, size_t& size)
 
 bool SaveState::save(void* data, size_t& size)
 {
-  // Open the state file and write the header
-  MemFile file;
+  // Write the header straight into the frontend's buffer
+  MemFile file(data, size);
 
   file.write(stateTag, sizeof(uint8_t), 4);
   file.write(&stateVersion, sizeof(uint32_t), 1);
 
   // Save the state of every component
-  core->memory.saveState(file);
-  core->bios[0].saveState(file);
-  core->bios[1].saveState(file);
-  core->bios[2].saveState(file);
-  core->cartridgeGba.saveState(file);
-  core->cartridgeNds.saveState(file);
-  core->cp15.saveState(file);
-  core->divSqrt.saveState(file);
-  core->dma[0].saveState(file);
-  core->dma[1].saveState(file);
-  core->gpu.saveState(file);
-  core->gpu2D[0].saveState(file);
-  core->gpu2D[1].saveState(file);
-  core->gpu3D.saveState(file);
-  core->gpu3DRenderer.saveState(file);
-  core->interpreter[0].saveState(file);
-  core->interpreter[1].saveState(file);
-  core->ipc.saveState(file);
-  core->rtc.saveState(file);
-  core->spi.saveState(file);
-  core->spu.saveState(file);
-  core->timers[0].saveState(file);
-  core->timers[1].saveState(file);
-  core->wifi.saveState(file);
-  core->saveState(file);
-
-  // Write save data to buffer
-  file.read(data, size, 1);
+  core->saveStates.saveSections(file);
 
-  return true;
+  // Fail if the state didn't fit in the buffer
+  return !file.failed();
 }
 
 bool SaveState::load(const void* data, size_t& size)
 {
-  // Open the state file and read past the header
-  MemFile file;
+  // Read the version from the header, straight out of the frontend's buffer
+  MemFile file(data, size);
+  file.seek(4, SEEK_SET);
+
+  uint32_t version;
+  file.read(&version, sizeof(uint32_t), 1);
+
+  // Load the state of every component from its section
+  if (version == stateVersion)
+    return core->saveStates.loadSections(file);
 
-  file.write(data, size, 1);
-  file.seek(8, SEEK_SET);
+  // Convert cycle counts from states made before they were 64-bit
+  bool oldCycles = (version == oldCyclesVersion);
 
-  // Load the state of every component
+  // Load the state of every component from older states, where they're stored back-to-back
   core->memory.loadState(file);
   core->bios[0].loadState(file);
   core->bios[1].loadState(file);
@@ -92,16 +83,16 @@ bool SaveState::load(const void* data, size_t& size)
   core->gpu2D[1].loadState(file);
   core->gpu3D.loadState(file);
   core->gpu3DRenderer.loadState(file);
-  core->interpreter[0].loadState(file);
-  core->interpreter[1].loadState(file);
+  core->interpreter[0].loadState(file, oldCycles);
+  core->interpreter[1].loadState(file, oldCycles);
   core->ipc.loadState(file);
   core->rtc.loadState(file);
   core->spi.loadState(file);
   core->spu.loadState(file);
-  core->timers[0].loadState(file);
-  core->timers[1].loadState(file);
+  core->timers[0].loadState(file, oldCycles);
+  core->timers[1].loadState(file, oldCycles);
   core->wifi.loadState(file);
-  core->loadState(file);
+  core->loadState(file, oldCycles);
 
   return true;
 }
@@ -11,6 +11,7 @@ class SaveState
 {
   public:
     SaveState(Core* core) : core(core) {}
+    size_t size();
     bool check(const void* data, size_t& size);
     bool save(void* data, size_t& size);
     bool load(const void* data, size_t& size);
@@ -19,6 +20,8 @@ class SaveState
     Core* core;
     static const char *stateTag;
     static const uint32_t stateVersion;
+    static const uint32_t oldCyclesVersion;
+    static const uint32_t linearVersion;
 };
 
 #endif // SAVESTATE_H
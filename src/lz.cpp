@@ -0,0 +1,168 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "lz.h"
+
+#define LZ_HASH_BITS 12
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 0xFFFF
+
+static inline uint32_t read32(const uint8_t *data)
+{
+    // Read 4 bytes at once for matching
+    uint32_t value;
+    memcpy(&value, data, 4);
+    return value;
+}
+
+static inline uint8_t *writeLength(uint8_t *dst, size_t length)
+{
+    // Write the part of a length that didn't fit in a token
+    for (; length >= 255; length -= 255)
+        *dst++ = 255;
+    *dst++ = length;
+    return dst;
+}
+
+size_t Lz::compress(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity)
+{
+    // Track the last position of each 4-byte hash to find matches
+    static const size_t hashSize = 1 << LZ_HASH_BITS;
+    uint32_t table[hashSize];
+    memset(table, 0xFF, sizeof(table));
+
+    const uint8_t *end = src + size;
+    const uint8_t *literal = src;
+    uint8_t *out = dst;
+
+    // Return 0 if the output doesn't fit, which is always avoided with a capacity of at least bound(size)
+    if (capacity < bound(size)) return 0;
+
+    for (const uint8_t *pos = src; pos + LZ_MIN_MATCH <= end;)
+    {
+        // Look up the last position with the same 4 bytes, and move on if it's too far back or doesn't match
+        uint32_t value = read32(pos);
+        uint32_t hash = (value * 2654435761U) >> (32 - LZ_HASH_BITS);
+        uint32_t last = table[hash];
+        table[hash] = pos - src;
+        if (last == 0xFFFFFFFF || (pos - src) - last > LZ_MAX_OFFSET || read32(src + last) != value)
+        {
+            pos++;
+            continue;
+        }
+
+        // Extend the match as far as it goes
+        const uint8_t *match = src + last;
+        size_t length = LZ_MIN_MATCH;
+        while (pos + length < end && match[length] == pos[length])
+            length++;
+
+        // Write a token with the literals before the match
+        size_t literals = pos - literal;
+        uint8_t *token = out++;
+        *token = (std::min<size_t>(literals, 15) << 4) | std::min<size_t>(length - LZ_MIN_MATCH, 15);
+        if (literals >= 15) out = writeLength(out, literals - 15);
+        memcpy(out, literal, literals);
+        out += literals;
+
+        // Write the match offset and any extra length
+        size_t offset = pos - match;
+        *out++ = offset;
+        *out++ = offset >> 8;
+        if (length - LZ_MIN_MATCH >= 15) out = writeLength(out, length - LZ_MIN_MATCH - 15);
+        pos += length;
+        literal = pos;
+    }
+
+    // Write the remaining data as a final sequence of literals
+    size_t literals = end - literal;
+    *out++ = std::min<size_t>(literals, 15) << 4;
+    if (literals >= 15) out = writeLength(out, literals - 15);
+    memcpy(out, literal, literals);
+    return (out + literals) - dst;
+}
+
+bool Lz::decompress(const uint8_t *src, size_t size, uint8_t *dst, size_t dstSize)
+{
+    const uint8_t *end = src + size;
+    uint8_t *out = dst;
+    uint8_t *outEnd = dst + dstSize;
+
+    while (src < end)
+    {
+        // Read the literal length, with any extra bytes
+        uint8_t token = *src++;
+        size_t literals = token >> 4;
+        if (literals == 15)
+        {
+            uint8_t byte;
+            do
+            {
+                if (src >= end) return false;
+                literals += (byte = *src++);
+            }
+            while (byte == 255);
+        }
+
+        // Copy the literals
+        if (literals > size_t(end - src) || literals > size_t(outEnd - out)) return false;
+        memcpy(out, src, literals);
+        src += literals;
+        out += literals;
+
+        // Stop after the final sequence, which has no match
+        if (src == end) break;
+
+        // Read the match offset and length, with any extra bytes
+        if (end - src < 2) return false;
+        size_t offset = src[0] | (src[1] << 8);
+        src += 2;
+        size_t length = (token & 0xF) + LZ_MIN_MATCH;
+        if ((token & 0xF) == 15)
+        {
+            uint8_t byte;
+            do
+            {
+                if (src >= end) return false;
+                length += (byte = *src++);
+            }
+            while (byte == 255);
+        }
+
+        // Copy the match byte by byte, since it can overlap with its own output
+        if (offset == 0 || offset > size_t(out - dst) || length > size_t(outEnd - out)) return false;
+        const uint8_t *match = out - offset;
+        if (offset >= length)
+        {
+            memcpy(out, match, length);
+            out += length;
+        }
+        else
+        {
+            for (size_t i = 0; i < length; i++)
+                *out++ = match[i];
+        }
+    }
+
+    // Make sure all of the output was filled
+    return out == outEnd;
+}
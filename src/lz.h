@@ -0,0 +1,38 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LZ_H
+#define LZ_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Simple byte-oriented LZ77 compression, fast enough to use while streaming ROM data or writing states
+// Data is a series of sequences, each with a token byte holding a literal length in the upper 4 bits
+// and a match length minus 4 in the lower 4 bits, where 15 means more length follows in 255-continued bytes
+// Literals come next, then a 16-bit offset back into the output for the match; the last sequence has no match
+class Lz
+{
+    public:
+        static size_t bound(size_t size) { return size + size / 255 + 16; }
+        static size_t compress(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity);
+        static bool decompress(const uint8_t *src, size_t size, uint8_t *dst, size_t dstSize);
+};
+
+#endif // LZ_H
@@ -1,19 +1,24 @@
 #ifndef MEMFILE_H
 #define MEMFILE_H
 
-#include <sstream>
+#include <algorithm>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <cwchar> // Declares functions that refer to fclose, so it must come before the overloads below
 #include <vector>
 
 #include "defines.h"
 
+// A file kept in one contiguous block of memory, written to disk in one go when closed
+// It can also wrap a caller's buffer, so states can be serialized into or out of it without copies
 class MemFile
 {
     public:
-        MemFile() : stream(), file(nullptr) {}
+        MemFile() : file(nullptr) {}
         ~MemFile() { close(); }
 
-        MemFile(FILE* cfile) : stream(), file(cfile)
+        MemFile(FILE* cfile) : file(cfile)
         {
             if (!file) return;
 
@@ -23,69 +28,125 @@ class MemFile
 
             if (fileSize > 0)
             {
-              std::vector<char> content(fileSize);
-              fread(content.data(), 1, fileSize, file);
-
-              stream.write(content.data(), fileSize);
-              stream.seekg(0, std::ios::beg);
-              stream.seekp(0, std::ios::beg);
+                buffer.resize(fileSize);
+                buffer.resize(fread(buffer.data(), 1, fileSize, file));
+                data = buffer.data();
+                size = capacity = buffer.size();
             }
         }
 
+        MemFile(void* cdata, size_t csize) : file(nullptr), data(static_cast<uint8_t*>(cdata)), capacity(csize), external(true) {}
+
+        MemFile(const void* cdata, size_t csize) : file(nullptr), data(static_cast<uint8_t*>(const_cast<void*>(cdata))),
+            size(csize), capacity(csize), external(true), readOnly(true) {}
+
+        // Copies would share the file handle and could point into each other's buffers, so they aren't allowed
+        MemFile(const MemFile&) = delete;
+        MemFile &operator=(const MemFile&) = delete;
+
         bool opened() const
         {
             return file != nullptr;
         }
 
-        size_t write(const void* buffer, size_t size, size_t count)
+        bool failed() const
         {
-            stream.write(static_cast<const char*>(buffer), size * count);
-            return size;
+            return error;
         }
 
-        size_t read(void* buffer, size_t size, size_t count)
+        uint8_t* getData() { return data; }
+        size_t getSize() const { return size; }
+
+        void reserve(size_t count)
         {
-            stream.read(static_cast<char*>(buffer), size * count);
-            return size;
+            // Grow the buffer ahead of time so writes don't have to reallocate
+            if (external || count <= capacity) return;
+            buffer.resize(count);
+            data = buffer.data();
+            capacity = count;
+        }
+
+        size_t write(const void* src, size_t size, size_t count)
+        {
+            // Grow an owned buffer as needed, but never write past the end of an external one
+            size_t length = size * count;
+            if (readOnly || (external && pos + length > capacity))
+            {
+                error = true;
+                return 0;
+            }
+            if (pos + length > capacity)
+                reserve(std::max(pos + length, capacity * 2));
+
+            // Fill any gap left by seeking past the end, then copy the data
+            // A null external buffer only counts what would be written, for measuring states
+            if (data)
+            {
+                if (pos > this->size)
+                    memset(data + this->size, 0, pos - this->size);
+                memcpy(data + pos, src, length);
+            }
+            pos += length;
+            written = true;
+            this->size = std::max(this->size, pos);
+            return count;
+        }
+
+        size_t read(void* dst, size_t size, size_t count)
+        {
+            // Only copy whole elements that are within the file
+            size_t avail = (pos < this->size) ? (this->size - pos) / (size ? size : 1) : 0;
+            if (count > avail)
+            {
+                error = true;
+                count = avail;
+            }
+            if (count) memcpy(dst, data + pos, size * count);
+            pos += size * count;
+            return count;
         }
 
         int seek(long offset, int origin)
         {
-            std::ios_base::seekdir dir;
+            long base;
 
             switch (origin)
             {
-                case SEEK_SET: dir = std::ios::beg; break;
-                case SEEK_CUR: dir = std::ios::cur; break;
-                case SEEK_END: dir = std::ios::end; break;
+                case SEEK_SET: base = 0; break;
+                case SEEK_CUR: base = pos; break;
+                case SEEK_END: base = size; break;
                 default: return -1;
             }
 
-            stream.seekg(offset, dir);
-            stream.seekp(offset, dir);
-
-            return stream.fail() ? -1 : 0;
+            if (base + offset < 0) return -1;
+            pos = base + offset;
+            return 0;
         }
 
         long tell()
         {
-            return static_cast<long>(stream.tellg());
+            return static_cast<long>(pos);
         }
 
         void close()
         {
             if (!file) return;
 
-            std::string content = stream.str();
-            fwrite(content.data(), 1, content.size(), file);
+            // Write everything to disk with a single call if anything was written
+            if (written)
+                fwrite(data, 1, size, file);
             fclose(file);
 
             file = nullptr;
         }
 
     private:
-        std::stringstream stream;
+        std::vector<uint8_t> buffer;
         FILE* file;
+        uint8_t* data = nullptr;
+        size_t size = 0, capacity = 0, pos = 0;
+        bool external = false, readOnly = false;
+        bool written = false, error = false;
 };
 
 FORCE_INLINE size_t fread(void* buffer, size_t size, size_t count, MemFile &file)
@@ -21,10 +21,48 @@
 #define MEMORY_H
 
 #include <cstdint>
+#include <vector>
+
 #include "defines.h"
 #include "memfile.h"
 
 class Core;
+class Memory;
+
+enum IoSet
+{
+    IO_NDS9 = 0,
+    IO_NDS7,
+    IO_GBA
+};
+
+struct IoHandler
+{
+    uint32_t address;
+    uint32_t size;
+    uint32_t (Memory::*read)();
+    void (Memory::*write)(uint32_t base, uint32_t mask, uint32_t data);
+};
+
+// Lookup table for the handlers of a set of I/O registers, indexed by the bytes they cover
+// Registers in the first 8KB of I/O space are indexed directly, and the few beyond it are searched
+// Each access width also has its own index of registers of that size, so those accesses take a single lookup
+struct IoTable
+{
+    uint16_t index[0x2000] = {};
+    uint16_t index8[0x2000] = {};
+    uint16_t index16[0x1000] = {};
+    uint16_t index32[0x800] = {};
+    std::vector<IoHandler> handlers;
+    std::vector<IoHandler> outer;
+
+    void add(IoHandler &handler);
+    IoHandler *find(uint32_t address);
+    template <typename T> IoHandler *findExact(uint32_t address);
+};
+
+template <IoSet set, uint32_t addr, uint32_t size> struct IoReader;
+template <IoSet set, uint32_t addr, uint32_t size> struct IoWriter;
 
 struct VramMapping
 {
@@ -36,6 +74,49 @@ struct VramMapping
     template <typename T> void write(uint32_t address, T value);
 };
 
+// Memory that the ARM9 can map, kept in one block so it can be shared with a fastmem view
+// Tracked memory comes first and back-to-back, so code flags can address all of it from main RAM
+struct MemoryArena
+{
+    uint8_t ram[0x1000000]; // 16MB main RAM
+    uint8_t wram[0x8000]; // 32KB shared WRAM
+    uint8_t instrTcm[0x8000]; // 32KB instruction TCM
+    uint8_t dataTcm[0x4000]; // 16KB data TCM
+    uint8_t wram7[0x10000]; // 64KB ARM7 WRAM
+
+    uint8_t vramA[0x20000]; // 128KB VRAM block A
+    uint8_t vramB[0x20000]; // 128KB VRAM block B
+    uint8_t vramC[0x20000]; // 128KB VRAM block C
+    uint8_t vramD[0x20000]; // 128KB VRAM block D
+    uint8_t vramE[0x10000]; // 64KB VRAM block E
+    uint8_t vramF[0x4000]; // 16KB VRAM block F
+    uint8_t vramG[0x4000]; // 16KB VRAM block G
+    uint8_t vramH[0x8000]; // 32KB VRAM block H
+    uint8_t vramI[0x4000]; // 16KB VRAM block I
+    uint8_t bios9[0x8000]; // 32KB ARM9 BIOS
+};
+
+// Number of 4KB pages in the arena, which are tracked for snapshots
+#define ARENA_PAGES (sizeof(MemoryArena) >> 12)
+static_assert(ARENA_PAGES < 0xFFFF, "Arena pages don't fit in the fastmem page records");
+
+// Snapshots that each keep their own record of the arena pages written since they were taken
+enum DirtySlot
+{
+    DIRTY_REWIND = 0,
+    DIRTY_RUNAHEAD
+};
+
+// Everything the memory maps are built from, so restoring a snapshot can skip remapping if it's unchanged
+struct MapState
+{
+    uint32_t vramCnt[9];
+    uint32_t wramCnt;
+    uint32_t tcmAccess;
+    uint32_t dtcmAddr, dtcmSize, itcmSize;
+    uint32_t modes;
+};
+
 class Memory
 {
     public:
@@ -46,9 +127,10 @@ class Memory
         uint8_t *tex3D[4] = {};
         uint8_t *pal3D[6] = {};
 
-        Memory(Core *core): core(core) {};
-        void saveState(MemFile &file);
-        void loadState(MemFile &file);
+        Memory(Core *core);
+        ~Memory();
+        void saveState(MemFile &file, bool arena = true);
+        void loadState(MemFile &file, bool arena = true);
 
         bool loadBios9();
         bool loadBios7();
@@ -58,8 +140,25 @@ class Memory
         void updateMap9(uint32_t start, uint32_t end, bool tcm = false);
         void updateMap7(uint32_t start, uint32_t end);
         void updateVram();
+        void updateMaps();
+        MapState getMapState();
         uint8_t *getRam() { return ram; }
 
+        uint8_t *getPage(uint32_t page) { return &ram[page << 12]; }
+        bool takeDirty(DirtySlot slot, uint32_t page);
+        void restorePage(DirtySlot slot, uint32_t page, const uint8_t *data);
+
+        uint8_t *getFastmem();
+
+        uint8_t *getCodePointer(bool arm7, uint32_t address);
+        void markCode(uint8_t *data, uint32_t size, bool jit = false);
+        bool watchIdle(bool arm7, uint32_t address);
+        void clearIdleWatch(bool arm7);
+
+        uint32_t copyBlock(bool arm7, uint32_t dst, uint32_t src, uint32_t count, uint32_t size, bool fill);
+        void readBlock(bool arm7, uint32_t address, uint8_t *data, uint32_t size);
+        void writeBlock(bool arm7, uint32_t address, const uint8_t *data, uint32_t size);
+
         template <typename T> T read(bool arm7, uint32_t address, bool tcm = true);
         template <typename T> void write(bool arm7, uint32_t address, T value, bool tcm = true);
 
@@ -67,34 +166,54 @@ class Memory
         Core *core;
         uint32_t gbaBiosAddr = 0;
 
-        // 32-bit address space, split into 4KB blocks
-        uint8_t *readMap9A[0x100000] = {};
-        uint8_t *readMap9B[0x100000] = {};
-        uint8_t *readMap7[0x100000] = {};
-        uint8_t *writeMap9A[0x100000] = {};
-        uint8_t *writeMap9B[0x100000] = {};
-        uint8_t *writeMap7[0x100000] = {};
+        // Shared memory backing the arena, and a 4GB view of the ARM9's address space that maps it
+        // Each 4KB block of the view records the arena page it maps plus 1, or 0 if it's left to fault
+        int arenaFd = -1;
+        MemoryArena *arena = createArena();
+        uint8_t *fastmem = nullptr;
+        std::vector<uint16_t> fastmemPages;
 
-        uint8_t bios9[0x8000] = {}; // 32KB ARM9 BIOS
+        // 32-bit address space, split into 1MB regions of 4KB blocks
+        // Regions are only given their own block tables once something is mapped in them
+        static uint8_t *emptyRegion[0x100];
+        uint8_t **readMap9A[0x1000];
+        uint8_t **readMap9B[0x1000];
+        uint8_t **readMap7[0x1000];
+        uint8_t **writeMap9A[0x1000];
+        uint8_t **writeMap9B[0x1000];
+        uint8_t **writeMap7[0x1000];
+
+        uint8_t (&bios9)[0x8000] = arena->bios9;
         uint8_t bios7[0x4000] = {}; // 16KB ARM7 BIOS
         uint8_t gbaBios[0x4000] = {}; // 16KB GBA BIOS
 
-        uint8_t ram[0x1000000] = {}; // 16MB main RAM
-        uint8_t wram[0x8000] = {}; // 32KB shared WRAM
-        uint8_t instrTcm[0x8000] = {}; // 32KB instruction TCM
-        uint8_t dataTcm[0x4000] = {}; // 16KB data TCM
-        uint8_t wram7[0x10000] = {}; // 64KB ARM7 WRAM
+        uint8_t (&ram)[0x1000000] = arena->ram;
+        uint8_t (&wram)[0x8000] = arena->wram;
+        uint8_t (&instrTcm)[0x8000] = arena->instrTcm;
+        uint8_t (&dataTcm)[0x4000] = arena->dataTcm;
+        uint8_t (&wram7)[0x10000] = arena->wram7;
         uint8_t wifiRam[0x2000] {}; // 8KB WiFi RAM
 
-        uint8_t vramA[0x20000] = {}; // 128KB VRAM block A
-        uint8_t vramB[0x20000] = {}; // 128KB VRAM block B
-        uint8_t vramC[0x20000] = {}; // 128KB VRAM block C
-        uint8_t vramD[0x20000] = {}; // 128KB VRAM block D
-        uint8_t vramE[0x10000] = {}; // 64KB VRAM block E
-        uint8_t vramF[0x4000] = {}; // 16KB VRAM block F
-        uint8_t vramG[0x4000] = {}; // 16KB VRAM block G
-        uint8_t vramH[0x8000] = {}; // 32KB VRAM block H
-        uint8_t vramI[0x4000] = {}; // 16KB VRAM block I
+        // Flags for 256-byte chunks of the memory from main RAM to ARM7 WRAM that have cached or compiled code
+        uint8_t codeChunks[(0x1000000 + 0x8000 + 0x8000 + 0x4000 + 0x10000) >> 8] = {};
+
+        // Flags for 4KB pages of the arena that were written, with a bit for each snapshot that hasn't copied them yet
+        uint8_t dirtyPages[ARENA_PAGES];
+
+        // Ranges of tracked memory polled by idle loops on each CPU, so writes from the other CPU can wake them
+        uint8_t *idleStart[2] = {};
+        uint8_t *idleEnd[2] = {};
+        bool idleIo[2] = {};
+
+        uint8_t (&vramA)[0x20000] = arena->vramA;
+        uint8_t (&vramB)[0x20000] = arena->vramB;
+        uint8_t (&vramC)[0x20000] = arena->vramC;
+        uint8_t (&vramD)[0x20000] = arena->vramD;
+        uint8_t (&vramE)[0x10000] = arena->vramE;
+        uint8_t (&vramF)[0x4000] = arena->vramF;
+        uint8_t (&vramG)[0x4000] = arena->vramG;
+        uint8_t (&vramH)[0x8000] = arena->vramH;
+        uint8_t (&vramI)[0x4000] = arena->vramI;
 
         VramMapping engABg[32];
         VramMapping engBBg[8];
@@ -109,15 +228,27 @@ class Memory
         uint8_t wramCnt = 0;
         uint8_t haltCnt = 0;
 
+        // Handlers for each I/O register set, for reads and writes
+        static IoTable ioTables[3][2];
+        template <IoSet, uint32_t, uint32_t> friend struct IoReader;
+        template <IoSet, uint32_t, uint32_t> friend struct IoWriter;
+
+        MemoryArena *createArena();
+        void updateFastmem(uint32_t start, uint32_t end);
+        void mapBlock(uint8_t ***map, uint32_t address, uint8_t *data);
+        bool regionMapped(bool arm7, uint32_t address);
+        void invalidateCode(size_t chunk);
+        void wakeIdle(bool arm7);
+        void markWritten(bool arm7, uint8_t *data, uint32_t size);
+        void markDirty(uint8_t *data, uint32_t size);
+
         template <typename T> T readFallback(bool arm7, uint32_t address);
         template <typename T> void writeFallback(bool arm7, uint32_t address, T value);
 
-        template <typename T> T ioRead9(uint32_t address);
-        template <typename T> T ioRead7(uint32_t address);
-        template <typename T> T ioReadGba(uint32_t address);
-        template <typename T> void ioWrite9(uint32_t address, T value);
-        template <typename T> void ioWrite7(uint32_t address, T value);
-        template <typename T> void ioWriteGba(uint32_t address, T value);
+        template <typename T> T ioRead(IoSet set, uint32_t address);
+        template <typename T> void ioWrite(IoSet set, uint32_t address, T value);
+        template <IoSet set, uint32_t addr> uint32_t ioReadReg();
+        template <IoSet set, uint32_t addr> void ioWriteReg(uint32_t base, uint32_t mask, uint32_t data);
 
         uint32_t readDmaFill(int channel) { return dmaFill[channel]; }
         uint8_t readVramCnt(int block) { return vramCnt[block]; }
@@ -138,8 +269,8 @@ template uint32_t Memory::read(bool arm7, uint32_t address, bool tcm);
 template <typename T> FORCE_INLINE T Memory::read(bool arm7, uint32_t address, bool tcm)
 {
     // Look up a pointer to readable memory and read a value from it LSB-first
-    uint8_t **readMap = arm7 ? readMap7 : (tcm ? readMap9A : readMap9B);
-    if (uint8_t *data = readMap[address >> 12])
+    uint8_t ***readMap = arm7 ? readMap7 : (tcm ? readMap9A : readMap9B);
+    if (uint8_t *data = readMap[address >> 20][(address >> 12) & 0xFF])
     {
         T value = 0;
         data += address & (0x1000 - sizeof(T));
@@ -158,12 +289,23 @@ template void Memory::write(bool arm7, uint32_t address, uint32_t value, bool tc
 template <typename T> FORCE_INLINE void Memory::write(bool arm7, uint32_t address, T value, bool tcm)
 {
     // Look up a pointer to writable memory and write a value to it LSB-first
-    uint8_t **writeMap = arm7 ? writeMap7 : (tcm ? writeMap9A : writeMap9B);
-    if (uint8_t *data = writeMap[address >> 12])
+    uint8_t ***writeMap = arm7 ? writeMap7 : (tcm ? writeMap9A : writeMap9B);
+    if (uint8_t *data = writeMap[address >> 20][(address >> 12) & 0xFF])
     {
         data += address & (0x1000 - sizeof(T));
         for (uint32_t i = 0; i < sizeof(T); i++)
             data[i] = value >> (i * 8);
+
+        // Flag the page for snapshots, and drop cached code if it was written over
+        size_t chunk = size_t(data - ram) >> 8;
+        if (chunk < (ARENA_PAGES << 4))
+            dirtyPages[chunk >> 4] = 0xFF;
+        if (chunk < sizeof(codeChunks) && codeChunks[chunk])
+            invalidateCode(chunk);
+
+        // Wake the other CPU if it's polling the written memory in an idle loop
+        if (data < idleEnd[!arm7] && data + sizeof(T) > idleStart[!arm7])
+            wakeIdle(!arm7);
         return;
     }
 
@@ -0,0 +1,67 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstdio>
+#include <cstring>
+
+#include "../packed_rom.h"
+
+int main(int argc, char **argv)
+{
+    // Show usage if the files weren't given
+    bool unpack = (argc > 1 && !strcmp(argv[1], "-d"));
+    if (argc < 3 + unpack)
+    {
+        printf("Usage: %s [-d] INPUT OUTPUT\n", argv[0]);
+        printf("Packs a ROM into independently compressed chunks, or unpacks it with -d\n");
+        printf("Packed ROMs keep working with their .nds or .gba extension\n");
+        return 1;
+    }
+
+    // Open the input and output files
+    FILE *in = fopen(argv[1 + unpack], "rb");
+    if (!in)
+    {
+        printf("Error opening %s\n", argv[1 + unpack]);
+        return 1;
+    }
+    FILE *out = fopen(argv[2 + unpack], "wb");
+    if (!out)
+    {
+        printf("Error opening %s\n", argv[2 + unpack]);
+        fclose(in);
+        return 1;
+    }
+
+    // Pack or unpack the ROM
+    bool success = unpack ? PackedRom::unpack(in, out) : PackedRom::pack(in, out);
+    long inSize = (fseek(in, 0, SEEK_END), ftell(in));
+    long outSize = (fseek(out, 0, SEEK_END), ftell(out));
+    fclose(in);
+    fclose(out);
+
+    // Report the result
+    if (!success)
+    {
+        printf("Error %s %s\n", unpack ? "unpacking" : "packing", argv[1 + unpack]);
+        return 1;
+    }
+    printf("%s: %ld bytes -> %ld bytes\n", argv[2 + unpack], inSize, outSize);
+    return 0;
+}
@@ -0,0 +1,177 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "packed_rom.h"
+#include "defines.h"
+#include "lz.h"
+
+static void write32(FILE *file, uint32_t value)
+{
+    // Write a 32-bit value LSB-first
+    uint8_t data[4];
+    U32TO8(data, 0, value);
+    fwrite(data, 1, 4, file);
+}
+
+static void write64(FILE *file, uint64_t value)
+{
+    // Write a 64-bit value LSB-first
+    write32(file, value);
+    write32(file, value >> 32);
+}
+
+bool PackedRom::pack(FILE *in, FILE *out)
+{
+    // Get the size of the input ROM
+    fseek(in, 0, SEEK_END);
+    uint64_t size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    uint32_t count = (size + PACKED_ROM_CHUNK - 1) / PACKED_ROM_CHUNK;
+
+    // Write the header, with space for chunk offsets that are filled in after
+    write32(out, PACKED_ROM_MAGIC);
+    write32(out, PACKED_ROM_VERSION);
+    write64(out, size);
+    write32(out, PACKED_ROM_CHUNK);
+    write32(out, count);
+    std::vector<uint64_t> offsets(count + 1);
+    for (uint32_t i = 0; i <= count; i++)
+        write64(out, 0);
+
+    // Compress each chunk on its own, storing it as-is if it doesn't get smaller
+    std::vector<uint8_t> data(PACKED_ROM_CHUNK), packed(Lz::bound(PACKED_ROM_CHUNK));
+    offsets[0] = 0x18 + (count + 1) * 8;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        size_t length = std::min<uint64_t>(size - uint64_t(i) * PACKED_ROM_CHUNK, PACKED_ROM_CHUNK);
+        if (fread(data.data(), 1, length, in) != length) return false;
+        size_t packedSize = Lz::compress(data.data(), length, packed.data(), packed.size());
+        if (packedSize < length)
+            fwrite(packed.data(), 1, packedSize, out);
+        else
+            fwrite(data.data(), 1, packedSize = length, out);
+        offsets[i + 1] = offsets[i] + packedSize;
+    }
+
+    // Fill in the chunk offsets
+    fseek(out, 0x18, SEEK_SET);
+    for (uint32_t i = 0; i <= count; i++)
+        write64(out, offsets[i]);
+    return !ferror(out);
+}
+
+bool PackedRom::unpack(FILE *in, FILE *out)
+{
+    // Open a packed ROM and write it back out in full
+    PackedRom rom(in);
+    if (!rom.open()) return false;
+    std::vector<uint8_t> data(rom.chunkSize);
+    for (size_t offset = 0; offset < rom.romSize; offset += rom.chunkSize)
+    {
+        size_t length = std::min<size_t>(rom.romSize - offset, rom.chunkSize);
+        if (!rom.read(data.data(), offset, length)) return false;
+        fwrite(data.data(), 1, length, out);
+    }
+    return !ferror(out);
+}
+
+bool PackedRom::open()
+{
+    // Get the size of the file, which everything in the header has to fit within
+    fseek(file, 0, SEEK_END);
+    uint64_t fileSize = ftell(file);
+
+    // Check for the magic number and a supported version
+    uint8_t header[0x18];
+    fseek(file, 0, SEEK_SET);
+    if (fread(header, 1, sizeof(header), file) != sizeof(header)) return false;
+    if (U8TO32(header, 0x00) != PACKED_ROM_MAGIC || U8TO32(header, 0x04) != PACKED_ROM_VERSION) return false;
+
+    // Read the ROM layout, making sure the ROM is no bigger than a cartridge and the chunks are a usable size
+    uint64_t size = U8TO64(header, 0x08);
+    chunkSize = U8TO32(header, 0x10);
+    uint64_t count = U8TO32(header, 0x14);
+    if (size > PACKED_ROM_MAX_SIZE || chunkSize == 0 || chunkSize > PACKED_ROM_MAX_CHUNK ||
+        count != (size + chunkSize - 1) / chunkSize)
+        return false;
+
+    // Read the chunk offsets, checking that the table fits in the file before allocating it
+    uint64_t tableSize = (count + 1) * 8;
+    if (sizeof(header) + tableSize > fileSize) return false;
+    std::vector<uint8_t> table(tableSize);
+    if (fread(table.data(), 1, table.size(), file) != table.size()) return false;
+
+    // Make sure the chunks come in order after the table and end within the file
+    offsets.resize(count + 1);
+    for (size_t i = 0; i <= count; i++)
+    {
+        offsets[i] = U8TO64(table.data(), i * 8);
+        if (i == 0 ? offsets[i] < sizeof(header) + tableSize :
+            (offsets[i] < offsets[i - 1] || offsets[i] - offsets[i - 1] > chunkSize))
+            return false;
+    }
+    if (offsets[count] > fileSize) return false;
+    romSize = size;
+    return true;
+}
+
+PackedRom::Chunk *PackedRom::loadChunk(size_t index)
+{
+    // Reuse a chunk if it was decompressed recently, since reads often touch the edges of neighbouring chunks
+    for (int i = 0; i < 3; i++)
+        if (chunks[i].index == index) return &chunks[i];
+
+    // Read the chunk's data from the file
+    Chunk *chunk = &chunks[nextChunk];
+    nextChunk = (nextChunk + 1) % 3;
+    size_t length = std::min<size_t>(romSize - index * chunkSize, chunkSize);
+    size_t packedSize = offsets[index + 1] - offsets[index];
+    buffer.resize(chunkSize);
+    chunk->data.resize(chunkSize);
+    chunk->index = -1;
+    fseek(file, offsets[index], SEEK_SET);
+    if (fread(buffer.data(), 1, packedSize, file) != packedSize) return nullptr;
+
+    // Decompress the chunk, unless it was stored as-is
+    if (packedSize == length)
+        memcpy(chunk->data.data(), buffer.data(), length);
+    else if (!Lz::decompress(buffer.data(), packedSize, chunk->data.data(), length))
+        return nullptr;
+    chunk->index = index;
+    return chunk;
+}
+
+bool PackedRom::read(uint8_t *out, size_t offset, size_t size)
+{
+    // Copy data from each chunk covered by a read
+    for (size_t pos = offset; pos < offset + size;)
+    {
+        size_t index = pos / chunkSize;
+        Chunk *chunk = (index < offsets.size() - 1) ? loadChunk(index) : nullptr;
+        if (!chunk) return false;
+        size_t start = pos % chunkSize;
+        size_t count = std::min<size_t>(chunkSize - start, offset + size - pos);
+        memcpy(&out[pos - offset], &chunk->data[start], count);
+        pos += count;
+    }
+    return true;
+}
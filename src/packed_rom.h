@@ -0,0 +1,70 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PACKED_ROM_H
+#define PACKED_ROM_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#define PACKED_ROM_MAGIC 0x4D52434E // "NCRM"
+#define PACKED_ROM_VERSION 1
+#define PACKED_ROM_CHUNK 0x10000
+#define PACKED_ROM_MAX_CHUNK 0x100000
+#define PACKED_ROM_MAX_SIZE 0x20000000
+
+// Reader and writer for packed ROMs, which are split into independently compressed chunks for random access
+// Layout, with all values little-endian:
+//   0x00: magic "NCRM", 0x04: version, 0x08: ROM size (64-bit, up to 512MB), 0x10: chunk size, 0x14: chunk count
+//   0x18: file offsets of each chunk's data, plus one for the end of the last (64-bit each)
+//   Chunk data follows, compressed with Lz, or stored as-is if that's no smaller
+// Only a few decompressed chunks are kept, since reads through the ROM cache are already cached
+class PackedRom
+{
+    public:
+        PackedRom(FILE *file): file(file) {}
+
+        static bool pack(FILE *in, FILE *out);
+        static bool unpack(FILE *in, FILE *out);
+
+        bool open();
+        bool read(uint8_t *out, size_t offset, size_t size);
+        size_t getSize() { return romSize; }
+
+    private:
+        struct Chunk
+        {
+            size_t index = -1;
+            std::vector<uint8_t> data;
+        };
+
+        FILE *file;
+        size_t romSize = 0;
+        uint32_t chunkSize = 0;
+        std::vector<uint64_t> offsets;
+        std::vector<uint8_t> buffer;
+
+        Chunk chunks[3];
+        int nextChunk = 0;
+
+        Chunk *loadChunk(size_t index);
+};
+
+#endif // PACKED_ROM_H
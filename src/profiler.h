@@ -0,0 +1,65 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+
+enum ProfileSection
+{
+    PROFILE_GPU_2D,
+    PROFILE_GPU_3D,
+    PROFILE_RENDER_3D,
+    PROFILE_SPU,
+    MAX_PROFILE_SECTIONS
+};
+
+// Enable or disable profiling counters, which are published per frame in Core::stats
+#ifdef PROFILE
+#define PROFILE_SCOPE(core, section) ProfileScope profileScope((core)->counters.sectionTimes[section])
+#define PROFILE_COUNT(core, counter) ((core)->counters.counter++)
+#define PROFILE_OPCODE(core, cpu, cycles) ((core)->counters.opcodes[cpu]++, (core)->counters.activeCycles[cpu] += (cycles))
+#define PROFILE_IDLE(core, cpu, cycles) ((core)->counters.idleSkips[cpu]++, (core)->counters.idleCycles[cpu] += (cycles))
+#else
+#define PROFILE_SCOPE(core, section)
+#define PROFILE_COUNT(core, counter) ((void)0)
+#define PROFILE_OPCODE(core, cpu, cycles) ((void)0)
+#define PROFILE_IDLE(core, cpu, cycles) ((void)0)
+#endif
+
+class ProfileScope
+{
+    public:
+        ProfileScope(uint64_t &time): time(time), start(std::chrono::steady_clock::now()) {}
+
+        ~ProfileScope()
+        {
+            // Add the host nanoseconds spent in the scope to its section's total
+            std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+            time += elapsed.count();
+        }
+
+    private:
+        uint64_t &time;
+        std::chrono::steady_clock::time_point start;
+};
+
+#endif // PROFILER_H
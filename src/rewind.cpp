@@ -0,0 +1,187 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "rewind.h"
+#include "core.h"
+#include "lz.h"
+#include "settings.h"
+
+// Size of the pages that the states of components other than memory are compared in
+#define REWIND_PAGE 0x1000
+
+void Rewind::update()
+{
+    // Step back to the previous snapshot while rewinding, instead of taking new ones
+    if (rewinding)
+    {
+        stepBack();
+        frameCount = 0;
+        return;
+    }
+
+    // Drop everything if rewinding was disabled, or take a snapshot at the set interval
+    if (Settings::rewindFrames <= 0)
+    {
+        if (!current.empty()) reset();
+        return;
+    }
+    if (++frameCount < Settings::rewindFrames) return;
+    frameCount = 0;
+    capture();
+}
+
+void Rewind::reset()
+{
+    // Free all snapshots
+    std::vector<uint8_t>().swap(pages);
+    std::vector<uint8_t>().swap(current);
+    std::vector<uint8_t>().swap(next);
+    currentSize = 0;
+    deltas.clear();
+    deltaBytes = 0;
+    frameCount = 0;
+}
+
+void Rewind::capture()
+{
+    // Save everything but the memory arena into a spare buffer, which is reused between snapshots
+    size_t size = core->saveStates.saveSnapshot(next);
+
+    // Copy all of memory and start over if there's nothing to compare with, like after the save was resized
+    if (pages.empty() || size != currentSize)
+    {
+        pages.resize(ARENA_PAGES << 12);
+        for (uint32_t i = 0; i < ARENA_PAGES; i++)
+        {
+            core->memory.takeDirty(DIRTY_REWIND, i);
+            memcpy(&pages[i << 12], core->memory.getPage(i), 0x1000);
+        }
+        current.swap(next);
+        currentSize = size;
+        deltas.clear();
+        deltaBytes = 0;
+        return;
+    }
+
+    // Store each memory page of the last snapshot that was written and changed, along with its offset
+    std::vector<uint8_t> delta;
+    for (uint32_t i = 0; i < ARENA_PAGES; i++)
+    {
+        if (!core->memory.takeDirty(DIRTY_REWIND, i)) continue;
+        uint8_t *page = core->memory.getPage(i);
+        uint32_t offset = i << 12;
+        if (!memcmp(&pages[offset], page, 0x1000)) continue;
+        delta.insert(delta.end(), (uint8_t*)&offset, (uint8_t*)&offset + sizeof(offset));
+        delta.insert(delta.end(), &pages[offset], &pages[offset] + 0x1000);
+        memcpy(&pages[offset], page, 0x1000);
+    }
+
+    // Store each page of everything else that changed, with offsets placed after the memory arena
+    for (uint32_t i = 0; i < currentSize; i += REWIND_PAGE)
+    {
+        uint32_t length = std::min<size_t>(REWIND_PAGE, currentSize - i);
+        if (!memcmp(&current[i], &next[i], length)) continue;
+        uint32_t offset = sizeof(MemoryArena) + i;
+        delta.insert(delta.end(), (uint8_t*)&offset, (uint8_t*)&offset + sizeof(offset));
+        delta.insert(delta.end(), &current[i], &current[i] + length);
+    }
+    current.swap(next);
+
+    // Compress the changes if enabled, keeping their original size in front
+    // They're stored as-is instead if compression doesn't make them smaller
+    uint32_t deltaSize = delta.size();
+    std::vector<uint8_t> stored(sizeof(deltaSize) + Lz::bound(deltaSize));
+    memcpy(&stored[0], &deltaSize, sizeof(deltaSize));
+    size_t packed = Settings::compressStates ? Lz::compress(delta.data(), deltaSize, &stored[sizeof(deltaSize)], stored.size() - sizeof(deltaSize)) : deltaSize;
+    if (packed < deltaSize)
+    {
+        stored.resize(sizeof(deltaSize) + packed);
+    }
+    else
+    {
+        stored.resize(sizeof(deltaSize) + deltaSize);
+        std::copy(delta.begin(), delta.end(), stored.begin() + sizeof(deltaSize));
+    }
+
+    // Add the changes to the ring, dropping the oldest ones to stay within the memory budget
+    deltaBytes += stored.size();
+    deltas.push_back(std::move(stored));
+    while (!deltas.empty() && deltaBytes > (size_t)Settings::rewindBudget << 20)
+    {
+        deltaBytes -= deltas.front().size();
+        deltas.pop_front();
+    }
+}
+
+bool Rewind::stepBack()
+{
+    // Expand the changes since the previous snapshot if they were compressed
+    if (deltas.empty()) return false;
+    std::vector<uint8_t> &stored = deltas.back();
+    uint32_t deltaSize;
+    memcpy(&deltaSize, &stored[0], sizeof(deltaSize));
+    const uint8_t *delta = stored.data() + sizeof(deltaSize);
+    std::vector<uint8_t> unpacked;
+    if (stored.size() - sizeof(deltaSize) != deltaSize)
+    {
+        unpacked.resize(deltaSize);
+        if (!Lz::decompress(delta, stored.size() - sizeof(deltaSize), unpacked.data(), deltaSize))
+        {
+            reset();
+            return false;
+        }
+        delta = unpacked.data();
+    }
+
+    // Put back memory pages that were written since the newest snapshot, so memory matches it again
+    for (uint32_t i = 0; i < ARENA_PAGES; i++)
+        if (core->memory.takeDirty(DIRTY_REWIND, i))
+            core->memory.restorePage(DIRTY_REWIND, i, &pages[i << 12]);
+
+    // Patch the pages that changed since the previous snapshot, copying memory pages straight back as well
+    for (size_t i = 0; i < deltaSize;)
+    {
+        uint32_t offset;
+        memcpy(&offset, &delta[i], sizeof(offset));
+        i += sizeof(offset);
+        if (offset < sizeof(MemoryArena))
+        {
+            memcpy(&pages[offset], &delta[i], 0x1000);
+            core->memory.restorePage(DIRTY_REWIND, offset >> 12, &pages[offset]);
+            i += 0x1000;
+        }
+        else
+        {
+            offset -= sizeof(MemoryArena);
+            uint32_t size = std::min<size_t>(REWIND_PAGE, currentSize - offset);
+            memcpy(&current[offset], &delta[i], size);
+            i += size;
+        }
+    }
+    deltaBytes -= stored.size();
+    deltas.pop_back();
+
+    // Load everything else from the previous snapshot through each component
+    MemFile file(static_cast<const void*>(current.data()), currentSize);
+    core->saveStates.loadSections(file, true);
+    return true;
+}
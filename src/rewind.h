@@ -0,0 +1,58 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class Core;
+
+// Ring of snapshots for stepping back through recent emulation
+// Only the newest snapshot is kept whole; older ones are stored as the pages that differ from the snapshot after them
+// Memory pages are only compared if they were written, and everything else is re-saved and compared each time
+// Frontends update it before each real frame, so frames that are run ahead and then undone are never captured
+class Rewind
+{
+    public:
+        Rewind(Core *core): core(core), rewinding(false) {}
+
+        void update();
+        void setRewinding(bool value) { rewinding = value; }
+        void reset();
+
+    private:
+        Core *core;
+        std::atomic<bool> rewinding;
+
+        std::vector<uint8_t> pages;
+        std::vector<uint8_t> current, next;
+        size_t currentSize = 0;
+        std::deque<std::vector<uint8_t>> deltas;
+        size_t deltaBytes = 0;
+        int frameCount = 0;
+
+        void capture();
+        bool stepBack();
+};
+
+#endif // REWIND_H
@@ -0,0 +1,180 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "rom_cache.h"
+#include "core.h"
+#include "packed_rom.h"
+
+RomCache::RomCache(Core *core, FILE *file, size_t size, PackedRom *packed):
+    core(core), file(file), romSize(size), packed(packed)
+{
+    // Allocate all chunks up front, so the cache never uses more memory than this
+    size_t chunkSize = ROM_CHUNK_SIZE + ROM_CHUNK_MARGIN * 2;
+    buffer = new uint8_t[chunkSize * ROM_CACHE_CHUNKS];
+    for (int i = 0; i < ROM_CACHE_CHUNKS; i++)
+        chunks[i].data = &buffer[chunkSize * i];
+}
+
+RomCache::~RomCache()
+{
+    // Stop the readahead thread before anything it uses is freed
+    if (thread)
+    {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            stopping = true;
+            requestCond.notify_one();
+        }
+        thread->join();
+        delete thread;
+    }
+    delete[] buffer;
+}
+
+RomCache::Chunk *RomCache::findChunk(size_t index)
+{
+    // Look for a chunk that's loaded or being loaded
+    for (int i = 0; i < ROM_CACHE_CHUNKS; i++)
+    {
+        if (chunks[i].state != CHUNK_EMPTY && chunks[i].index == index)
+            return &chunks[i];
+    }
+    return nullptr;
+}
+
+RomCache::Chunk *RomCache::claimChunk(size_t index)
+{
+    // Take the least-recently-used chunk that isn't being loaded, and mark it to be loaded with a new index
+    Chunk *chunk = nullptr;
+    for (int i = 0; i < ROM_CACHE_CHUNKS; i++)
+    {
+        if (chunks[i].state != CHUNK_LOADING && (!chunk || chunks[i].lastUse < chunk->lastUse))
+            chunk = &chunks[i];
+    }
+    chunk->index = index;
+    chunk->lastUse = ++useCount;
+    chunk->state = CHUNK_LOADING;
+    return chunk;
+}
+
+void RomCache::loadChunk(Chunk *chunk)
+{
+    // Read a chunk from the file along with its margins, leaving zeros past either end
+    size_t offset = chunk->index * ROM_CHUNK_SIZE;
+    size_t start = (offset > ROM_CHUNK_MARGIN) ? (offset - ROM_CHUNK_MARGIN) : 0;
+    size_t end = std::min<size_t>(offset + ROM_CHUNK_SIZE + ROM_CHUNK_MARGIN, romSize);
+    uint8_t *data = &chunk->data[ROM_CHUNK_MARGIN - (offset - start)];
+    memset(chunk->data, 0, ROM_CHUNK_SIZE + ROM_CHUNK_MARGIN * 2);
+
+    // Share the file between threads without sharing its position
+    std::lock_guard<std::mutex> guard(fileMutex);
+    if (packed)
+    {
+        // Leave the chunk zeroed if its packed data can't be read, since streaming can't fail the load
+        if (!packed->read(data, start, end - start))
+        {
+            LOG("Error reading packed ROM data at offset 0x%X\n", uint32_t(start));
+            memset(chunk->data, 0, ROM_CHUNK_SIZE + ROM_CHUNK_MARGIN * 2);
+        }
+        return;
+    }
+    fseek(file, start, SEEK_SET);
+    fread(data, sizeof(uint8_t), end - start, file);
+}
+
+void RomCache::read(uint8_t *out, size_t offset, size_t size)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (size_t pos = offset; pos < offset + size;)
+    {
+        // Load a chunk right away if it's missing, or wait for it if it's being loaded ahead of time
+        size_t index = pos / ROM_CHUNK_SIZE;
+        Chunk *chunk = findChunk(index);
+        if (!chunk)
+        {
+            chunk = claimChunk(index);
+            lock.unlock();
+            loadChunk(chunk);
+            lock.lock();
+            chunk->state = CHUNK_READY;
+        }
+        else if (chunk->state == CHUNK_LOADING)
+        {
+            loadCond.wait(lock, [&]{ return chunk->state != CHUNK_LOADING; });
+            continue;
+        }
+
+        // Patch DLDI drivers in a chunk the first time it's used, including ones that start in the lower margin
+        // Patching is kept on the emulation thread, since the DLDI state isn't shared with the readahead thread
+        if (chunk->state == CHUNK_READY)
+        {
+            size_t start = std::min<size_t>(chunk->index * ROM_CHUNK_SIZE, ROM_CHUNK_MARGIN);
+            core->dldi.patchRom(&chunk->data[ROM_CHUNK_MARGIN - start], chunk->index * ROM_CHUNK_SIZE - start, ROM_CHUNK_SIZE + start);
+            chunk->state = CHUNK_PATCHED;
+        }
+
+        // Copy data from the chunk
+        size_t start = pos % ROM_CHUNK_SIZE;
+        size_t count = std::min<size_t>(ROM_CHUNK_SIZE - start, offset + size - pos);
+        memcpy(&out[pos - offset], &chunk->data[ROM_CHUNK_MARGIN + start], count);
+        chunk->lastUse = ++useCount;
+        pos += count;
+    }
+
+    // Replace any pending readahead with the chunks that follow this read, since cart reads are usually sequential
+    requests.clear();
+    for (size_t i = 1; i <= ROM_READAHEAD_CHUNKS; i++)
+    {
+        size_t index = (offset + size - 1) / ROM_CHUNK_SIZE + i;
+        if (index * ROM_CHUNK_SIZE < romSize && !findChunk(index))
+            requests.push_back(index);
+    }
+
+    // Wake the readahead thread, starting it on first use
+    if (requests.empty()) return;
+    if (!thread) thread = new std::thread(&RomCache::runReadahead, this);
+    requestCond.notify_one();
+}
+
+void RomCache::runReadahead()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true)
+    {
+        // Wait for chunks to be requested
+        requestCond.wait(lock, [&]{ return stopping || !requests.empty(); });
+        if (stopping) return;
+        size_t index = requests.front();
+        requests.pop_front();
+        if (findChunk(index)) continue;
+
+        // Load a chunk without holding the lock, so reads of other chunks aren't blocked
+        Chunk *chunk = claimChunk(index);
+        lock.unlock();
+        loadChunk(chunk);
+        lock.lock();
+        chunk->state = CHUNK_READY;
+        loadCond.notify_all();
+    }
+}
@@ -0,0 +1,88 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef ROM_CACHE_H
+#define ROM_CACHE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#define ROM_CHUNK_SIZE 0x10000
+#define ROM_CACHE_CHUNKS 32
+#define ROM_READAHEAD_CHUNKS 2
+#define ROM_CHUNK_MARGIN 0x100
+
+class Core;
+class PackedRom;
+
+// Fixed-size cache of ROM file chunks, for when the ROM isn't kept in memory
+// Chunks are evicted least-recently-used, and the ones after a read are loaded ahead of time on a separate thread
+// Each chunk is read with margins from its neighbours, so DLDI drivers that cross its edges can still be patched
+// Data comes straight from the ROM file, or from a packed ROM that decompresses it
+class RomCache
+{
+    public:
+        RomCache(Core *core, FILE *file, size_t size, PackedRom *packed = nullptr);
+        ~RomCache();
+
+        void read(uint8_t *out, size_t offset, size_t size);
+
+    private:
+        enum ChunkState
+        {
+            CHUNK_EMPTY = 0,
+            CHUNK_LOADING,
+            CHUNK_READY,
+            CHUNK_PATCHED
+        };
+
+        struct Chunk
+        {
+            size_t index = 0;
+            uint32_t lastUse = 0;
+            ChunkState state = CHUNK_EMPTY;
+            uint8_t *data = nullptr;
+        };
+
+        Core *core;
+        FILE *file;
+        size_t romSize;
+        PackedRom *packed;
+
+        Chunk chunks[ROM_CACHE_CHUNKS];
+        uint8_t *buffer = nullptr;
+        uint32_t useCount = 0;
+
+        std::thread *thread = nullptr;
+        std::deque<size_t> requests;
+        std::condition_variable requestCond, loadCond;
+        std::mutex mutex, fileMutex;
+        bool stopping = false;
+
+        Chunk *findChunk(size_t index);
+        Chunk *claimChunk(size_t index);
+        void loadChunk(Chunk *chunk);
+        void runReadahead();
+};
+
+#endif // ROM_CACHE_H
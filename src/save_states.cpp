@@ -17,11 +17,197 @@
     along with NooDS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
 #include "save_states.h"
 #include "core.h"
+#include "lz.h"
+#include "settings.h"
+
+// Header flag for states with sections that are compressed in chunks
+#define STATE_COMPRESSED BIT(0)
+
+// Size of the chunks that compressed states are split into, so they can be handled in parallel
+#define STATE_CHUNK 0x40000
 
 const char *SaveStates::stateTag = "NOOD";
-const uint32_t SaveStates::stateVersion = 4;
+const uint32_t SaveStates::stateVersion = 7;
+const uint32_t SaveStates::oldCyclesVersion = 4;
+const uint32_t SaveStates::linearVersion = 5;
+const uint32_t SaveStates::unflaggedVersion = 6;
+
+// Reset a component by loading it from the state of a freshly constructed one
+template <typename T, typename... Args> static void resetState(T &component, Core *core, Args... args)
+{
+    std::unique_ptr<T> fresh(new T(core, args...));
+    MemFile state;
+    fresh->saveState(state);
+    MemFile reader(static_cast<const void*>(state.getData()), state.getSize());
+    component.loadState(reader);
+}
+
+// A tagged section of a state, holding the data of one component
+// Components missing from a state are reset, except for ones without a reset that every state must have
+// The core, cartridges, and memory hold the scheduler, saves, and arena, which can't be rebuilt from scratch
+// Sections are padded to fit their variable-length data at its largest, so states stay the same size
+// Memory has its own functions for snapshots, which leave out the arena since it's copied by page instead
+struct StateSection
+{
+    char tag[5];
+    void (*save)(Core *core, MemFile &file);
+    void (*load)(Core *core, MemFile &file);
+    void (*reset)(Core *core);
+    uint32_t (*padding)(Core *core);
+    void (*saveSnapshot)(Core *core, MemFile &file);
+    void (*loadSnapshot)(Core *core, MemFile &file);
+};
+
+static const StateSection sections[] =
+{
+    { "CORE", [](Core *c, MemFile &f) { c->saveState(f); }, [](Core *c, MemFile &f) { c->loadState(f); },
+        nullptr, [](Core *c) { return c->getStatePadding(); } },
+    { "BIO9", [](Core *c, MemFile &f) { c->bios[0].saveState(f); }, [](Core *c, MemFile &f) { c->bios[0].loadState(f); },
+        [](Core *c) { resetState(c->bios[0], c, false, Bios::swiTable9); } },
+    { "BIO7", [](Core *c, MemFile &f) { c->bios[1].saveState(f); }, [](Core *c, MemFile &f) { c->bios[1].loadState(f); },
+        [](Core *c) { resetState(c->bios[1], c, true, Bios::swiTable7); } },
+    { "BIOG", [](Core *c, MemFile &f) { c->bios[2].saveState(f); }, [](Core *c, MemFile &f) { c->bios[2].loadState(f); },
+        [](Core *c) { resetState(c->bios[2], c, true, Bios::swiTableGba); } },
+    { "CRTG", [](Core *c, MemFile &f) { c->cartridgeGba.saveState(f); }, [](Core *c, MemFile &f) { c->cartridgeGba.loadState(f); },
+        nullptr, [](Core *c) { return c->cartridgeGba.getStatePadding(); } },
+    { "CRTN", [](Core *c, MemFile &f) { c->cartridgeNds.saveState(f); }, [](Core *c, MemFile &f) { c->cartridgeNds.loadState(f); },
+        nullptr, [](Core *c) { return c->cartridgeNds.getStatePadding(); } },
+    { "CP15", [](Core *c, MemFile &f) { c->cp15.saveState(f); }, [](Core *c, MemFile &f) { c->cp15.loadState(f); },
+        [](Core *c) { resetState(c->cp15, c); } },
+    { "DVSQ", [](Core *c, MemFile &f) { c->divSqrt.saveState(f); }, [](Core *c, MemFile &f) { c->divSqrt.loadState(f); },
+        [](Core *c) { resetState(c->divSqrt, c); } },
+    { "DMA9", [](Core *c, MemFile &f) { c->dma[0].saveState(f); }, [](Core *c, MemFile &f) { c->dma[0].loadState(f); },
+        [](Core *c) { resetState(c->dma[0], c, false); } },
+    { "DMA7", [](Core *c, MemFile &f) { c->dma[1].saveState(f); }, [](Core *c, MemFile &f) { c->dma[1].loadState(f); },
+        [](Core *c) { resetState(c->dma[1], c, true); } },
+    { "GPU ", [](Core *c, MemFile &f) { c->gpu.saveState(f); }, [](Core *c, MemFile &f) { c->gpu.loadState(f); },
+        [](Core *c) { resetState(c->gpu, c); } },
+    { "G2DA", [](Core *c, MemFile &f) { c->gpu2D[0].saveState(f); }, [](Core *c, MemFile &f) { c->gpu2D[0].loadState(f); },
+        [](Core *c) { resetState(c->gpu2D[0], c, false); } },
+    { "G2DB", [](Core *c, MemFile &f) { c->gpu2D[1].saveState(f); }, [](Core *c, MemFile &f) { c->gpu2D[1].loadState(f); },
+        [](Core *c) { resetState(c->gpu2D[1], c, true); } },
+    { "GX3D", [](Core *c, MemFile &f) { c->gpu3D.saveState(f); }, [](Core *c, MemFile &f) { c->gpu3D.loadState(f); },
+        [](Core *c) { resetState(c->gpu3D, c); },
+        [](Core *c) { return c->gpu3D.getStatePadding(); } },
+    { "R3D ", [](Core *c, MemFile &f) { c->gpu3DRenderer.saveState(f); }, [](Core *c, MemFile &f) { c->gpu3DRenderer.loadState(f); },
+        [](Core *c) { resetState(c->gpu3DRenderer, c); } },
+    { "ARM9", [](Core *c, MemFile &f) { c->interpreter[0].saveState(f); }, [](Core *c, MemFile &f) { c->interpreter[0].loadState(f); },
+        [](Core *c) { resetState(c->interpreter[0], c, false); } },
+    { "ARM7", [](Core *c, MemFile &f) { c->interpreter[1].saveState(f); }, [](Core *c, MemFile &f) { c->interpreter[1].loadState(f); },
+        [](Core *c) { resetState(c->interpreter[1], c, true); } },
+    { "IPC ", [](Core *c, MemFile &f) { c->ipc.saveState(f); }, [](Core *c, MemFile &f) { c->ipc.loadState(f); },
+        [](Core *c) { resetState(c->ipc, c); },
+        [](Core *c) { return c->ipc.getStatePadding(); } },
+    { "MEM ", [](Core *c, MemFile &f) { c->memory.saveState(f); }, [](Core *c, MemFile &f) { c->memory.loadState(f); },
+        nullptr, nullptr,
+        [](Core *c, MemFile &f) { c->memory.saveState(f, false); }, [](Core *c, MemFile &f) { c->memory.loadState(f, false); } },
+    { "RTC ", [](Core *c, MemFile &f) { c->rtc.saveState(f); }, [](Core *c, MemFile &f) { c->rtc.loadState(f); },
+        [](Core *c) { resetState(c->rtc, c); } },
+    { "SPI ", [](Core *c, MemFile &f) { c->spi.saveState(f); }, [](Core *c, MemFile &f) { c->spi.loadState(f); },
+        [](Core *c) { resetState(c->spi, c); } },
+    { "SPU ", [](Core *c, MemFile &f) { c->spu.saveState(f); }, [](Core *c, MemFile &f) { c->spu.loadState(f); },
+        [](Core *c) { resetState(c->spu, c); },
+        [](Core *c) { return c->spu.getStatePadding(); } },
+    { "TMR9", [](Core *c, MemFile &f) { c->timers[0].saveState(f); }, [](Core *c, MemFile &f) { c->timers[0].loadState(f); },
+        [](Core *c) { resetState(c->timers[0], c, false); } },
+    { "TMR7", [](Core *c, MemFile &f) { c->timers[1].saveState(f); }, [](Core *c, MemFile &f) { c->timers[1].loadState(f); },
+        [](Core *c) { resetState(c->timers[1], c, true); } },
+    { "WIFI", [](Core *c, MemFile &f) { c->wifi.saveState(f); }, [](Core *c, MemFile &f) { c->wifi.loadState(f); },
+        [](Core *c) { resetState(c->wifi, c); } }
+};
+
+template <typename F> static void runChunks(uint32_t count, F func)
+{
+    // Handle chunks on as many threads as there are cores, with the calling thread taking part
+    std::atomic<uint32_t> next(0);
+    auto worker = [&]() { for (uint32_t i; (i = next++) < count;) func(i); };
+    uint32_t extra = std::min<uint32_t>(std::max(std::thread::hardware_concurrency(), 1U), count) - 1;
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < extra; i++)
+        threads.emplace_back(worker);
+    worker();
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+}
+
+static void compressChunks(const uint8_t *src, uint32_t size, std::vector<uint8_t> &dst)
+{
+    // Compress each chunk on its own, storing it as-is if it doesn't get smaller
+    uint32_t count = (size + STATE_CHUNK - 1) / STATE_CHUNK;
+    std::vector<std::vector<uint8_t>> chunks(count);
+    runChunks(count, [&](uint32_t i)
+    {
+        uint32_t length = std::min<uint32_t>(size - i * STATE_CHUNK, STATE_CHUNK);
+        chunks[i].resize(Lz::bound(length));
+        size_t packed = Lz::compress(&src[i * STATE_CHUNK], length, chunks[i].data(), chunks[i].size());
+        if (packed < length)
+            chunks[i].resize(packed);
+        else
+            chunks[i].assign(&src[i * STATE_CHUNK], &src[i * STATE_CHUNK] + length);
+    });
+
+    // Write the original size and the size of each chunk, followed by the chunks
+    size_t start = dst.size();
+    dst.resize(start + (count + 1) * 4);
+    U32TO8(&dst[start], 0, size);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        U32TO8(&dst[start], (i + 1) * 4, chunks[i].size());
+        dst.insert(dst.end(), chunks[i].begin(), chunks[i].end());
+    }
+}
+
+static bool decompressChunks(const uint8_t *src, size_t size, std::vector<uint8_t> &dst)
+{
+    // Read the original size and find where each chunk starts, making sure they're all within the data
+    if (size < 4) return false;
+    uint32_t count = (U8TO32(src, 0) + STATE_CHUNK - 1) / STATE_CHUNK;
+    if (size < (count + 1) * 4) return false;
+    std::vector<size_t> offsets(count + 1, (count + 1) * 4);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t packed = U8TO32(src, (i + 1) * 4);
+        if (packed > STATE_CHUNK || packed > size - offsets[i]) return false;
+        offsets[i + 1] = offsets[i] + packed;
+    }
+
+    // Decompress the chunks in parallel, copying any that were stored as-is
+    dst.resize(U8TO32(src, 0));
+    std::atomic<bool> valid(true);
+    runChunks(count, [&](uint32_t i)
+    {
+        uint32_t length = std::min<uint32_t>(dst.size() - i * STATE_CHUNK, STATE_CHUNK);
+        size_t packed = offsets[i + 1] - offsets[i];
+        if (packed == length)
+            memcpy(&dst[i * STATE_CHUNK], &src[offsets[i]], length);
+        else if (!Lz::decompress(&src[offsets[i]], packed, &dst[i * STATE_CHUNK], length))
+            valid = false;
+    });
+    return valid;
+}
+
+SaveStates::~SaveStates()
+{
+    // Finish writing any state before exiting, and stop the thread that writes them
+    flushState();
+    if (writeThread)
+    {
+        {
+            std::lock_guard<std::mutex> guard(writeMutex);
+            writeStopping = true;
+            writeCond.notify_all();
+        }
+        writeThread->join();
+        delete writeThread;
+    }
+}
 
 void SaveStates::setPath(std::string path, bool gba)
 {
@@ -35,22 +221,39 @@ void SaveStates::setFd(int fd, bool gba)
     (gba ? gbaFd : ndsFd) = fd;
 }
 
-FILE *SaveStates::openFile(const char *mode)
+void SaveStates::selectFile(std::string &path, int &fd)
 {
-    // Open the NDS or GBA state file based on what's running
+    // Choose the NDS or GBA state file based on what's running
+    path = "";
+    fd = -1;
     if (gbaFd != -1 && (core->gbaMode || ndsFd == -1))
-        return fdopen(dup(gbaFd), mode);
+        fd = gbaFd;
     else if (ndsFd != -1)
-        return fdopen(dup(ndsFd), mode);
+        fd = ndsFd;
     else if (gbaPath != "" && (core->gbaMode || ndsPath == ""))
-        return fopen(gbaPath.c_str(), mode);
-    else if (ndsPath != "")
-        return fopen(ndsPath.c_str(), mode);
+        path = gbaPath;
+    else
+        path = ndsPath;
+}
+
+FILE *SaveStates::openFile(const char *mode)
+{
+    // Open the NDS or GBA state file
+    std::string path;
+    int fd;
+    selectFile(path, fd);
+    if (fd != -1)
+        return fdopen(dup(fd), mode);
+    else if (path != "")
+        return fopen(path.c_str(), mode);
     return nullptr;
 }
 
 StateResult SaveStates::checkState()
 {
+    // Wait for a state that's still being written, so it isn't checked partially
+    flushState();
+
     // Try to open the state file, if it exists
     FILE *file = openFile("rb");
     if (!file) return STATE_FILE_FAIL;
@@ -71,59 +274,169 @@ StateResult SaveStates::checkState()
         if (tag[i] != stateTag[i])
             return STATE_FORMAT_FAIL;
 
-    // Check if the state version matches
-    if (version != stateVersion)
+    // Check if the state version matches, allowing older states that can be converted
+    if (version != stateVersion && version != unflaggedVersion && version != linearVersion && version != oldCyclesVersion)
         return STATE_VERSION_FAIL;
     return STATE_SUCCESS;
 }
 
 bool SaveStates::saveState()
 {
-    // Open the state file and write the header
-    MemFile file(openFile("wb"));
-    if (!file.opened()) return false;
-    fwrite(stateTag, sizeof(uint8_t), 4, file);
-    fwrite(&stateVersion, sizeof(uint32_t), 1, file);
-
-    // Save the state of every component
-    core->saveState(file);
-    core->bios[0].saveState(file);
-    core->bios[1].saveState(file);
-    core->bios[2].saveState(file);
-    core->cartridgeGba.saveState(file);
-    core->cartridgeNds.saveState(file);
-    core->cp15.saveState(file);
-    core->divSqrt.saveState(file);
-    core->dma[0].saveState(file);
-    core->dma[1].saveState(file);
-    core->gpu.saveState(file);
-    core->gpu2D[0].saveState(file);
-    core->gpu2D[1].saveState(file);
-    core->gpu3D.saveState(file);
-    core->gpu3DRenderer.saveState(file);
-    core->interpreter[0].saveState(file);
-    core->interpreter[1].saveState(file);
-    core->ipc.saveState(file);
-    core->memory.saveState(file);
-    core->rtc.saveState(file);
-    core->spi.saveState(file);
-    core->spu.saveState(file);
-    core->timers[0].saveState(file);
-    core->timers[1].saveState(file);
-    core->wifi.saveState(file);
-    fclose(file);
+    // Wait until the last state is written, so its copy can be reused
+    std::unique_lock<std::mutex> lock(writeMutex);
+    writeCond.wait(lock, [&]{ return !writePending; });
+    selectFile(copyPath, copyFd);
+    if (copyFd == -1 && copyPath == "") return false;
+
+    // Copy the state into memory, only holding up emulation for as long as that takes
+    // The header only marks the sections for compression, which is left to the writer thread
+    {
+        TRACE_SCOPE("State Copy");
+        uint32_t flags = Settings::compressStates ? STATE_COMPRESSED : 0;
+        stateCopy.resize(getSectionsSize() + 12);
+        MemFile file(static_cast<void*>(stateCopy.data()), stateCopy.size());
+        fwrite(stateTag, sizeof(uint8_t), 4, file);
+        fwrite(&stateVersion, sizeof(uint32_t), 1, file);
+        fwrite(&flags, sizeof(uint32_t), 1, file);
+        saveSections(file);
+    }
+
+    // Hand the copy to the writer thread, starting it on first use
+    // This only means the state was queued; whether it reached the disk is reported by getWriteStatus()
+    writePending = true;
+    if (!writeThread) writeThread = new std::thread(&SaveStates::runStateWriter, this);
+    writeCond.notify_all();
     return true;
 }
 
+bool SaveStates::flushState()
+{
+    // Wait until the last state is on disk, and return whether it was written successfully
+    std::unique_lock<std::mutex> lock(writeMutex);
+    writeCond.wait(lock, [&]{ return !writePending; });
+    return writeOk;
+}
+
+StateWrite SaveStates::getWriteStatus()
+{
+    // Check if the last state is still being written or failed to write, so frontends can report it
+    std::lock_guard<std::mutex> guard(writeMutex);
+    return writePending ? WRITE_PENDING : (writeOk ? WRITE_DONE : WRITE_FAILED);
+}
+
+void SaveStates::runStateWriter()
+{
+    std::unique_lock<std::mutex> lock(writeMutex);
+
+    while (true)
+    {
+        // Wait for a state, and stop once everything is written
+        writeCond.wait(lock, [&]{ return writePending || writeStopping; });
+        if (!writePending) return;
+
+        // Write the copy without holding the lock, so the next state can be waited for in the meantime
+        // The copy is kept afterwards, so later states can be taken without allocating it again
+        lock.unlock();
+        bool ok = writeStateFile();
+        lock.lock();
+        writeOk = ok;
+        writePending = false;
+        writeCond.notify_all();
+    }
+}
+
+bool SaveStates::writeStateFile()
+{
+    TRACE_SCOPE("State Write");
+    LOG("Writing state file to disk\n");
+
+    // Compress the sections if the header says to, keeping the header as-is
+    std::vector<uint8_t> packed;
+    const std::vector<uint8_t> *data = &stateCopy;
+    if (U8TO32(stateCopy.data(), 8) & STATE_COMPRESSED)
+    {
+        TRACE_SCOPE("State Compress");
+        packed.assign(stateCopy.begin(), stateCopy.begin() + 12);
+        compressChunks(&stateCopy[12], stateCopy.size() - 12, packed);
+        data = &packed;
+    }
+
+    if (copyFd != -1)
+    {
+        // Write over the descriptor's file from the start, trimming anything left from a larger state
+        FILE *file = fdopen(dup(copyFd), "wb");
+        if (!file) return false;
+        fseek(file, 0, SEEK_SET);
+        bool written = (fwrite(data->data(), sizeof(uint8_t), data->size(), file) == data->size());
+        written &= !fflush(file) && !ftruncate(fileno(file), data->size()) && !fsync(fileno(file));
+        fclose(file);
+        return written;
+    }
+
+    // Write the whole state to a temporary file and flush it to disk
+    std::string tempPath = copyPath + ".tmp";
+    FILE *file = fopen(tempPath.c_str(), "wb");
+    if (!file) return false;
+    bool written = (fwrite(data->data(), sizeof(uint8_t), data->size(), file) == data->size());
+    written &= !fflush(file) && !fsync(fileno(file));
+    fclose(file);
+
+    // Replace the state file with the new one, so an interrupted write never leaves it incomplete
+    // Windows can't rename over an existing file, so it has to be removed first there
+    if (written)
+    {
+#ifdef WINDOWS
+        remove(copyPath.c_str());
+#endif
+        written = !rename(tempPath.c_str(), copyPath.c_str());
+    }
+    else
+    {
+        remove(tempPath.c_str());
+    }
+    return written;
+}
+
 bool SaveStates::loadState()
 {
-    // Open the state file and read past the header
+    // Wait for a state that's still being written, so it isn't loaded partially
+    flushState();
+
+    // Open the state file and read the version from the header
     MemFile file(openFile("rb"));
     if (!file.opened()) return false;
-    fseek(file, 8, SEEK_SET);
+    uint32_t version;
+    fseek(file, 4, SEEK_SET);
+    fread(&version, sizeof(uint32_t), 1, file);
+
+    // Load the state of every component from its section, decompressing them first if needed
+    // Nothing is loaded if the compressed data is damaged, so the current state is kept
+    if (version == stateVersion)
+    {
+        uint32_t flags = 0;
+        fread(&flags, sizeof(uint32_t), 1, file);
+        if (flags & STATE_COMPRESSED)
+        {
+            std::vector<uint8_t> sections;
+            bool valid = decompressChunks(file.getData() + 12, file.getSize() - std::min<size_t>(file.getSize(), 12), sections);
+            fclose(file);
+            if (!valid) return false;
+            MemFile unpacked(static_cast<const void*>(sections.data()), sections.size());
+            return loadSections(unpacked);
+        }
+    }
+    if (version == stateVersion || version == unflaggedVersion)
+    {
+        bool loaded = loadSections(file);
+        fclose(file);
+        return loaded;
+    }
+
+    // Convert cycle counts from states made before they were 64-bit
+    bool oldCycles = (version == oldCyclesVersion);
 
-    // Load the state of every component
-    core->loadState(file);
+    // Load the state of every component from older states, where they're stored back-to-back
+    core->loadState(file, oldCycles);
     core->bios[0].loadState(file);
     core->bios[1].loadState(file);
     core->bios[2].loadState(file);
@@ -138,16 +451,118 @@ bool SaveStates::loadState()
     core->gpu2D[1].loadState(file);
     core->gpu3D.loadState(file);
     core->gpu3DRenderer.loadState(file);
-    core->interpreter[0].loadState(file);
-    core->interpreter[1].loadState(file);
+    core->interpreter[0].loadState(file, oldCycles);
+    core->interpreter[1].loadState(file, oldCycles);
     core->ipc.loadState(file);
     core->memory.loadState(file);
     core->rtc.loadState(file);
     core->spi.loadState(file);
     core->spu.loadState(file);
-    core->timers[0].loadState(file);
-    core->timers[1].loadState(file);
+    core->timers[0].loadState(file, oldCycles);
+    core->timers[1].loadState(file, oldCycles);
     core->wifi.loadState(file);
     fclose(file);
     return true;
 }
+
+size_t SaveStates::getSectionsSize(bool snapshot)
+{
+    // Measure the sections by writing them to a file that only counts their size
+    MemFile file(static_cast<void*>(nullptr), SIZE_MAX);
+    saveSections(file, snapshot);
+    return file.getSize();
+}
+
+size_t SaveStates::saveSnapshot(std::vector<uint8_t> &buffer)
+{
+    // Write the sections of a snapshot into a buffer that's reused between snapshots
+    // It's only measured and grown when they don't fit, like after the save was resized
+    MemFile file(static_cast<void*>(buffer.data()), buffer.size());
+    saveSections(file, true);
+    if (!file.failed()) return file.getSize();
+    buffer.resize(getSectionsSize(true));
+    MemFile retry(static_cast<void*>(buffer.data()), buffer.size());
+    saveSections(retry, true);
+    return retry.getSize();
+}
+
+void SaveStates::saveSections(MemFile &file, bool snapshot)
+{
+    static const uint8_t zeros[0x400] = {};
+
+    for (size_t i = 0; i < sizeof(sections) / sizeof(StateSection); i++)
+    {
+        // Write the section's tag, with space for its size
+        uint32_t size = 0;
+        fwrite(sections[i].tag, sizeof(uint8_t), 4, file);
+        fwrite(&size, sizeof(uint32_t), 1, file);
+
+        // Write the component's state, padded to its largest size
+        long start = ftell(file);
+        if (snapshot && sections[i].saveSnapshot)
+            sections[i].saveSnapshot(core, file);
+        else
+            sections[i].save(core, file);
+        uint32_t padding = sections[i].padding ? sections[i].padding(core) : 0;
+        for (uint32_t j = 0; j < padding; j += sizeof(zeros))
+            fwrite(zeros, sizeof(uint8_t), std::min<uint32_t>(padding - j, sizeof(zeros)), file);
+
+        // Go back and fill in the section's size
+        long end = ftell(file);
+        size = end - start;
+        fseek(file, start - 4, SEEK_SET);
+        fwrite(&size, sizeof(uint32_t), 1, file);
+        fseek(file, end, SEEK_SET);
+    }
+}
+
+bool SaveStates::loadSections(MemFile &file, bool snapshot)
+{
+    // Check that each section is within the file, and that every component without a reset has one
+    // Nothing is loaded from a truncated state, so the current state is kept
+    char tag[4];
+    uint32_t size;
+    long first = ftell(file);
+    uint32_t found = 0;
+    while (fread(tag, sizeof(uint8_t), 4, file) == 4 && fread(&size, sizeof(uint32_t), 1, file) == 1)
+    {
+        long start = ftell(file);
+        if (start + size > (long)file.getSize()) return false;
+        for (size_t i = 0; i < sizeof(sections) / sizeof(StateSection); i++)
+            if (!memcmp(tag, sections[i].tag, 4)) found |= BIT(i);
+        fseek(file, start + size, SEEK_SET);
+    }
+    for (size_t i = 0; i < sizeof(sections) / sizeof(StateSection); i++)
+        if (!(found & BIT(i)) && !sections[i].reset) return false;
+
+    // Reset components that are missing, like ones added after the state was made
+    MapState maps = core->memory.getMapState();
+    for (size_t i = 0; i < sizeof(sections) / sizeof(StateSection); i++)
+        if (!(found & BIT(i))) sections[i].reset(core);
+
+    // Read sections until the end of the file
+    fseek(file, first, SEEK_SET);
+    while (fread(tag, sizeof(uint8_t), 4, file) == 4 && fread(&size, sizeof(uint32_t), 1, file) == 1)
+    {
+        // Load the component with a matching tag from its section, skipping any that are unknown
+        // Components read in place, and anything missing from the end of a section is left as it was
+        long start = ftell(file);
+        for (size_t i = 0; i < sizeof(sections) / sizeof(StateSection); i++)
+        {
+            if (memcmp(tag, sections[i].tag, 4)) continue;
+            MemFile section(static_cast<const void*>(file.getData() + start), size);
+            if (snapshot && sections[i].loadSnapshot)
+                sections[i].loadSnapshot(core, section);
+            else
+                sections[i].load(core, section);
+            break;
+        }
+        fseek(file, start + size, SEEK_SET);
+    }
+
+    // Rebuild the memory maps for snapshots only if they changed, since that drops all cached code
+    MapState loaded = core->memory.getMapState();
+    if (snapshot && memcmp(&maps, &loaded, sizeof(MapState)))
+        core->memory.updateMaps();
+    return true;
+}
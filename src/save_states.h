@@ -20,8 +20,12 @@
 #ifndef SAVE_STATES_H
 #define SAVE_STATES_H
 
+#include <condition_variable>
 #include <cstdint>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "memfile.h"
 
@@ -35,16 +39,31 @@ enum StateResult
     STATE_VERSION_FAIL
 };
 
+enum StateWrite
+{
+    WRITE_DONE,
+    WRITE_PENDING,
+    WRITE_FAILED
+};
+
 class SaveStates
 {
     public:
         SaveStates(Core *core): core(core) {}
+        ~SaveStates();
         void setPath(std::string path, bool gba);
         void setFd(int fd, bool gba);
 
         StateResult checkState();
         bool saveState();
         bool loadState();
+        bool flushState();
+        StateWrite getWriteStatus();
+
+        size_t getSectionsSize(bool snapshot = false);
+        size_t saveSnapshot(std::vector<uint8_t> &buffer);
+        void saveSections(MemFile &file, bool snapshot = false);
+        bool loadSections(MemFile &file, bool snapshot = false);
 
     private:
         Core *core;
@@ -53,8 +72,23 @@ class SaveStates
 
         static const char *stateTag;
         static const uint32_t stateVersion;
+        static const uint32_t oldCyclesVersion;
+        static const uint32_t linearVersion;
+        static const uint32_t unflaggedVersion;
+
+        // Copy of a state that's written to disk on a separate thread
+        std::vector<uint8_t> stateCopy;
+        std::string copyPath;
+        int copyFd = -1;
+        std::thread *writeThread = nullptr;
+        std::condition_variable writeCond;
+        std::mutex writeMutex;
+        bool writePending = false, writeStopping = false, writeOk = true;
 
+        void selectFile(std::string &path, int &fd);
         FILE *openFile(const char *mode);
+        void runStateWriter();
+        bool writeStateFile();
 };
 
 #endif // SAVE_STATES_H
@@ -24,6 +24,7 @@
 int Settings::directBoot = 1;
 int Settings::fpsLimiter = 1;
 int Settings::romInRam = 0;
+int Settings::mmapRom = 1;
 int Settings::threaded2D = 1;
 int Settings::threaded3D = 1;
 int Settings::highRes3D = 0;
@@ -33,6 +34,12 @@ int Settings::savesFolder = 0;
 int Settings::statesFolder = 1;
 int Settings::cheatsFolder = 1;
 int Settings::dsiMode = 0;
+int Settings::arm9Jit = 0;
+int Settings::idleLoops = 1;
+int Settings::fastmem = 0;
+int Settings::rewindFrames = 0;
+int Settings::rewindBudget = 64;
+int Settings::compressStates = 1;
 
 std::string Settings::bios9Path = "bios9.bin";
 std::string Settings::bios7Path = "bios7.bin";
@@ -46,6 +53,7 @@ std::vector<Setting> Settings::settings =
     Setting("directBoot", &directBoot, false),
     Setting("fpsLimiter", &fpsLimiter, false),
     Setting("romInRam", &romInRam, false),
+    Setting("mmapRom", &mmapRom, false),
     Setting("threaded2D", &threaded2D, false),
     Setting("threaded3D", &threaded3D, false),
     Setting("highRes3D", &highRes3D, false),
@@ -55,6 +63,12 @@ std::vector<Setting> Settings::settings =
     Setting("statesFolder", &statesFolder, false),
     Setting("cheatsFolder", &cheatsFolder, false),
     Setting("dsiMode", &dsiMode, false),
+    Setting("arm9Jit", &arm9Jit, false),
+    Setting("idleLoops", &idleLoops, false),
+    Setting("fastmem", &fastmem, false),
+    Setting("rewindFrames", &rewindFrames, false),
+    Setting("rewindBudget", &rewindBudget, false),
+    Setting("compressStates", &compressStates, false),
     Setting("bios9Path", &bios9Path, true),
     Setting("bios7Path", &bios7Path, true),
     Setting("firmwarePath", &firmwarePath, true),
@@ -39,6 +39,7 @@ class Settings
         static int directBoot;
         static int fpsLimiter;
         static int romInRam;
+        static int mmapRom;
         static int threaded2D;
         static int threaded3D;
         static int highRes3D;
@@ -48,6 +49,12 @@ class Settings
         static int statesFolder;
         static int cheatsFolder;
         static int dsiMode;
+        static int arm9Jit;
+        static int idleLoops;
+        static int fastmem;
+        static int rewindFrames;
+        static int rewindBudget;
+        static int compressStates;
 
         static std::string bios9Path;
         static std::string bios7Path;
@@ -71,7 +71,7 @@ class Spi
 
         int16_t *micBuffer = nullptr;
         size_t micBufSize = 0;
-        uint32_t micCycles = 0;
+        uint64_t micCycles = 0;
         uint32_t micStep = 0;
         uint16_t micSample = 0;
         std::mutex mutex;
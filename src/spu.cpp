@@ -165,6 +165,12 @@ void Spu::loadState(MemFile &file)
     }
 }
 
+uint32_t Spu::getStatePadding()
+{
+    // Get the space needed to fill both GBA FIFOs to their 32-byte capacity in states
+    return (64 - gbaFifos[0].size() - gbaFifos[1].size()) * sizeof(int8_t);
+}
+
 uint32_t *Spu::getSamples(int count)
 {
     // Initialize the buffers
@@ -185,6 +191,7 @@ uint32_t *Spu::getSamples(int count)
     // So if it's taking too long, just let it play an empty buffer
     if (Settings::fpsLimiter == 2) // Accurate
     {
+        TRACE_SCOPE("Audio Fill Wait");
         std::chrono::steady_clock::time_point waitTime = std::chrono::steady_clock::now();
         wait = false;
 
@@ -203,6 +210,7 @@ uint32_t *Spu::getSamples(int count)
     {
         // Use a condition variable to save CPU cycles
         // This might take longer than expected due to the OS scheduler and other factors
+        TRACE_SCOPE("Audio Fill Wait");
         std::unique_lock<std::mutex> lock(mutex2);
         wait = !cond2.wait_for(lock, std::chrono::microseconds(1000000 / 60), [&]{ return ready.load(); });
     }
@@ -233,6 +241,8 @@ uint32_t *Spu::getSamples(int count)
 
 void Spu::runGbaSample()
 {
+    PROFILE_SCOPE(core, PROFILE_SPU);
+
     int64_t sampleLeft = 0;
     int64_t sampleRight = 0;
 
@@ -489,7 +499,7 @@ void Spu::runGbaSample()
     sampleLeft  = (sampleLeft  - 0x200) << 5;
     sampleRight = (sampleRight - 0x200) << 5;
 
-    if (bufferSize > 0)
+    if (bufferSize > 0 && outputEnabled)
     {
         // Write the samples to the buffer
         bufferIn[bufferPointer++] = (sampleRight << 16) | (sampleLeft & 0xFFFF);
@@ -505,6 +515,8 @@ void Spu::runGbaSample()
 
 void Spu::runSample()
 {
+    PROFILE_SCOPE(core, PROFILE_SPU);
+
     int64_t mixerLeft = 0, mixerRight = 0;
     int64_t channelsLeft[2] = {}, channelsRight[2] = {};
 
@@ -792,7 +804,7 @@ void Spu::runSample()
     sampleLeft  = (sampleLeft  - 0x200) << 5;
     sampleRight = (sampleRight - 0x200) << 5;
 
-    if (bufferSize > 0)
+    if (bufferSize > 0 && outputEnabled)
     {
         // Write the samples to the buffer
         bufferIn[bufferPointer++] = (sampleRight << 16) | (sampleLeft & 0xFFFF);
@@ -812,11 +824,13 @@ void Spu::swapBuffers()
     // Synchronizing to the audio eliminites the potential for nasty audio crackles
     if (Settings::fpsLimiter == 2) // Accurate
     {
+        TRACE_SCOPE("Audio Wait");
         std::chrono::steady_clock::time_point waitTime = std::chrono::steady_clock::now();
         while (ready.load() && std::chrono::steady_clock::now() - waitTime <= std::chrono::microseconds(1000000));
     }
     else if (Settings::fpsLimiter == 1) // Light
     {
+        TRACE_SCOPE("Audio Wait");
         std::unique_lock<std::mutex> lock(mutex1);
         cond1.wait_for(lock, std::chrono::microseconds(1000000), [&]{ return !ready.load(); });
     }
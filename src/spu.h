@@ -39,8 +39,10 @@ class Spu
 
         void saveState(MemFile &file);
         void loadState(MemFile &file);
+        uint32_t getStatePadding();
 
         uint32_t *getSamples(int count);
+        void setOutput(bool enabled) { outputEnabled = enabled; }
         void runGbaSample();
         void runSample();
         void gbaFifoTimer(int timer);
@@ -87,6 +89,7 @@ class Spu
 
         uint32_t *bufferIn = nullptr, *bufferOut = nullptr;
         uint32_t bufferSize = 0, bufferPointer = 0;
+        bool outputEnabled = true;
 
         std::condition_variable cond1, cond2;
         std::mutex mutex1, mutex2;
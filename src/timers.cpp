@@ -25,28 +25,32 @@ void Timers::saveState(MemFile &file)
     // Write state data to the file
     fwrite(timers, 2, sizeof(timers) / 2, file);
     fwrite(shifts, 1, sizeof(shifts), file);
-    fwrite(endCycles, 4, sizeof(endCycles) / 4, file);
+    fwrite(endCycles, 8, sizeof(endCycles) / 8, file);
     fwrite(tmCntL, 2, sizeof(tmCntL) / 2, file);
     fwrite(tmCntH, 2, sizeof(tmCntH) / 2, file);
 }
 
-void Timers::loadState(MemFile &file)
+void Timers::loadState(MemFile &file, bool oldCycles)
 {
     // Read state data from the file
     fread(timers, 2, sizeof(timers) / 2, file);
     fread(shifts, 1, sizeof(shifts), file);
-    fread(endCycles, 4, sizeof(endCycles) / 4, file);
+    if (oldCycles)
+    {
+        // Widen the end cycles from old states that stored them as 32-bit
+        uint32_t cycles[4];
+        fread(cycles, 4, sizeof(cycles) / 4, file);
+        for (int i = 0; i < 4; i++)
+            endCycles[i] = cycles[i];
+    }
+    else
+    {
+        fread(endCycles, 8, sizeof(endCycles) / 8, file);
+    }
     fread(tmCntL, 2, sizeof(tmCntL) / 2, file);
     fread(tmCntH, 2, sizeof(tmCntH) / 2, file);
 }
 
-void Timers::resetCycles()
-{
-    // Adjust timer end cycles for a global cycle reset
-    for (int i = 0; i < 4; i++)
-        endCycles[i] -= core->globalCycles;
-}
-
 void Timers::overflow(int timer)
 {
     // Ensure the timer is enabled and the end cycle is correct if not in count-up mode
@@ -119,6 +123,11 @@ void Timers::writeTmCntH(int timer, uint16_t mask, uint16_t value)
         core->schedule(SchedTask(TIMER9_OVERFLOW0 + (arm7 << 2) + timer), (0x10000 - timers[timer]) << shifts[timer]);
         endCycles[timer] = core->globalCycles + ((0x10000 - timers[timer]) << shifts[timer]);
     }
+    else if (!(tmCntH[timer] & BIT(7)))
+    {
+        // Drop a pending overflow if the timer was disabled
+        core->unschedule(SchedTask(TIMER9_OVERFLOW0 + (arm7 << 2) + timer));
+    }
 }
 
 uint16_t Timers::readTmCntL(int timer)
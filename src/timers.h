@@ -32,9 +32,8 @@ class Timers
     public:
         Timers(Core *core, bool arm7): core(core), arm7(arm7) {}
         void saveState(MemFile &file);
-        void loadState(MemFile &file);
+        void loadState(MemFile &file, bool oldCycles = false);
 
-        void resetCycles();
         void overflow(int timer);
 
         uint16_t readTmCntH(int timer) { return tmCntH[timer]; }
@@ -49,7 +48,7 @@ class Timers
 
         uint16_t timers[4] = {};
         uint8_t shifts[4] = {};
-        uint32_t endCycles[4] = {};
+        uint64_t endCycles[4] = {};
 
         uint16_t tmCntL[4] = {};
         uint16_t tmCntH[4] = {};
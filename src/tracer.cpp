@@ -0,0 +1,153 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstdio>
+
+#include "tracer.h"
+
+std::atomic<bool> Tracer::enabled(false);
+std::mutex Tracer::mutex;
+std::vector<TraceLane*> Tracer::lanes;
+
+// Each thread records to its own lane, which is freed for reuse when the thread exits
+struct LaneHolder
+{
+    TraceLane *lane = nullptr;
+    const char *name = nullptr;
+
+    ~LaneHolder()
+    {
+        if (!lane) return;
+        std::lock_guard<std::mutex> guard(lane->mutex);
+        lane->active = false;
+    }
+};
+
+static thread_local LaneHolder holder;
+
+void Tracer::setEnabled(bool value)
+{
+    // Clear old events when starting a new trace
+    if (value && !enabled.load())
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        for (size_t i = 0; i < lanes.size(); i++)
+        {
+            std::lock_guard<std::mutex> laneGuard(lanes[i]->mutex);
+            lanes[i]->count = 0;
+        }
+    }
+
+    enabled.store(value);
+}
+
+void Tracer::setThreadName(const char *name)
+{
+    // Set the name shown for the current thread, applied once it starts recording
+    holder.name = name;
+    if (holder.lane)
+    {
+        std::lock_guard<std::mutex> guard(holder.lane->mutex);
+        holder.lane->name = name;
+    }
+}
+
+uint64_t Tracer::now()
+{
+    // Get the current host time in nanoseconds
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TraceLane *Tracer::getLane()
+{
+    // Use the thread's lane if it already has one
+    if (holder.lane)
+        return holder.lane;
+
+    // Reuse a lane from a thread that exited, or add a new one
+    std::lock_guard<std::mutex> guard(mutex);
+    TraceLane *lane = nullptr;
+    for (size_t i = 0; i < lanes.size() && !lane; i++)
+    {
+        std::lock_guard<std::mutex> laneGuard(lanes[i]->mutex);
+        if (lanes[i]->active) continue;
+        lanes[i]->active = true;
+        lanes[i]->name = holder.name;
+        lane = lanes[i];
+    }
+
+    if (!lane)
+    {
+        lane = new TraceLane();
+        lane->active = true;
+        lane->name = holder.name;
+        lanes.push_back(lane);
+    }
+
+    return (holder.lane = lane);
+}
+
+void Tracer::record(const char *name, uint64_t start)
+{
+    // Add a finished span to the thread's ring buffer, overwriting the oldest if full
+    TraceLane *lane = getLane();
+    uint64_t end = now();
+    std::lock_guard<std::mutex> guard(lane->mutex);
+    TraceEvent &event = lane->events[lane->count++ % (sizeof(lane->events) / sizeof(TraceEvent))];
+    event.name = name;
+    event.start = start;
+    event.duration = end - start;
+}
+
+bool Tracer::dump(std::string path)
+{
+    // Open the output file
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    // Write the recorded spans of each lane in Chrome trace event format
+    std::lock_guard<std::mutex> guard(mutex);
+    fprintf(file, "{\"traceEvents\":[\n");
+    for (size_t i = 0; i < lanes.size(); i++)
+    {
+        std::lock_guard<std::mutex> laneGuard(lanes[i]->mutex);
+        TraceLane &lane = *lanes[i];
+
+        // Name the lane after its thread
+        if (lane.name)
+            fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"%s\"}},\n", i, lane.name);
+        else
+            fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"Thread %zu\"}},\n", i, i);
+
+        // Write the events still in the ring buffer, oldest first
+        uint64_t size = sizeof(lane.events) / sizeof(TraceEvent);
+        for (uint64_t j = (lane.count > size) ? (lane.count - size) : 0; j < lane.count; j++)
+        {
+            TraceEvent &event = lane.events[j % size];
+            fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f},\n",
+                event.name, i, event.start / 1000.0, event.duration / 1000.0);
+        }
+    }
+
+    // Close the array with a metadata event so there's no trailing comma
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"NooDS\"}}\n]}\n");
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,80 @@
+/*
+    Copyright 2019-2024 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct TraceEvent
+{
+    const char *name;
+    uint64_t start;
+    uint64_t duration;
+};
+
+struct TraceLane
+{
+    std::mutex mutex;
+    const char *name = nullptr;
+    TraceEvent events[0x10000];
+    uint64_t count = 0;
+    bool active = false;
+};
+
+class Tracer
+{
+    public:
+        static std::atomic<bool> enabled;
+
+        static void setEnabled(bool value);
+        static void setThreadName(const char *name);
+        static bool dump(std::string path);
+
+        static uint64_t now();
+        static void record(const char *name, uint64_t start);
+
+    private:
+        static std::mutex mutex;
+        static std::vector<TraceLane*> lanes;
+
+        static TraceLane *getLane();
+        Tracer() {} // Private to prevent instantiation
+};
+
+class TraceScope
+{
+    public:
+        TraceScope(const char *name): name(name), start(Tracer::enabled.load(std::memory_order_relaxed) ? Tracer::now() : 0) {}
+        ~TraceScope() { if (start) Tracer::record(name, start); }
+
+    private:
+        const char *name;
+        uint64_t start;
+};
+
+// Record a span for the rest of the current scope when tracing is enabled
+#define TRACE_SCOPE(name) TraceScope traceScope(name)
+
+#endif // TRACER_H